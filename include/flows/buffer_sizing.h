@@ -0,0 +1,194 @@
+#ifndef FLOW_TABLE_BUFFER_SIZING_H
+#define FLOW_TABLE_BUFFER_SIZING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flow_table {
+
+/**
+ * @brief 数据包方向，同时表示源角色
+ */
+enum class PacketDirection {
+    C2S,    // 客户端到服务器
+    S2C     // 服务器到客户端
+};
+
+// 缓冲区除literal之外还需要容纳的响应行和结尾（字节）
+const size_t LITERAL_HEADROOM = 4096;
+
+/**
+ * @brief 单个方向的缓冲区大小
+ */
+struct BufferSizes {
+    size_t initial = 256;      // 首次写入时分配的底层存储大小（字节）
+    size_t maximum = 0;        // 缓冲区容量上限（字节）
+};
+
+/**
+ * @brief 一个流两个方向的缓冲区大小
+ */
+struct BufferProfile {
+    BufferSizes c2s;           // C2S方向
+    BufferSizes s2c;           // S2C方向
+    bool mirrored = false;     // 两个方向都尽量使用镜像存储（见CircularString），对所有端口生效
+};
+
+/**
+ * @brief 缓冲区大小策略接口
+ *
+ * 流表在创建流时按服务器端口向策略查询两个方向的缓冲区大小，
+ * 并在数据包中发现IMAP literal（{N}\r\n）时通知策略，由策略决定该方向的缓冲区可以扩容到多大，
+ * 避免大的FETCH响应或APPEND数据被环形缓冲区覆盖。每个流表持有一个策略对象。
+ */
+class BufferSizingPolicy {
+public:
+    virtual ~BufferSizingPolicy() {}
+
+    /**
+     * @brief 获取新建流的缓冲区大小
+     * @param serverPort 服务器端口（C2S方向的目标端口）
+     * @return 两个方向的初始大小和容量上限
+     */
+    virtual BufferProfile profileFor(int serverPort) const = 0;
+
+    /**
+     * @brief 记录观察到的literal大小
+     * @param serverPort 服务器端口
+     * @param direction literal所在的方向
+     * @param literalSize literal声明的字节数
+     * @return 该方向缓冲区允许扩容到的容量上限，0表示不扩容
+     */
+    virtual size_t observeLiteral(int serverPort, PacketDirection direction, size_t literalSize) = 0;
+};
+
+/**
+ * @brief 按服务器端口区分的缓冲区大小策略
+ *
+ * 未单独配置的端口使用默认大小。策略按端口和方向统计观察到的literal大小（平均值和峰值），
+ * 之后新建的流按统计结果提高首次分配的存储大小和容量上限，减少增长时的复制；
+ * 当某个literal超过当前容量上限时，允许该流的缓冲区扩容到能容纳literal，但不超过literal上限。
+ * 常见的小命令和小响应只占用很小的缓冲区，大邮件也不会被截断。
+ */
+class PortBufferSizingPolicy : public BufferSizingPolicy {
+public:
+    /**
+     * @brief 构造函数
+     * @param defaults 未单独配置的端口使用的缓冲区大小
+     * @param literalCeiling 根据literal扩容时的容量上限（字节），0表示不根据literal扩容
+     */
+    explicit PortBufferSizingPolicy(const BufferProfile& defaults, size_t literalCeiling = 0);
+
+    /**
+     * @brief 为指定的服务器端口设置缓冲区大小
+     * @param serverPort 服务器端口
+     * @param profile 两个方向的缓冲区大小
+     */
+    void setPortProfile(int serverPort, const BufferProfile& profile);
+
+    /**
+     * @brief 设置根据literal扩容时的容量上限
+     * @param literalCeiling 容量上限（字节），0表示不根据literal扩容
+     */
+    void setLiteralCeiling(size_t literalCeiling) { this->literalCeiling = literalCeiling; }
+
+    BufferProfile profileFor(int serverPort) const override;
+
+    size_t observeLiteral(int serverPort, PacketDirection direction, size_t literalSize) override;
+
+    /**
+     * @brief 解析配置中的缓冲区大小，格式为"C2S初始,C2S上限,S2C初始,S2C上限"
+     * @param text 配置字符串
+     * @param profile 解析结果
+     * @return 格式无效时返回false且不修改profile
+     */
+    static bool parseProfile(const std::string& text, BufferProfile& profile);
+
+private:
+    // literal大小统计
+    struct LiteralStats {
+        uint64_t samples = 0;      // 观察到的literal数量
+        size_t average = 0;        // 指数加权平均值（权重1/8）
+        size_t peak = 0;           // 最大值
+    };
+
+    // 单个端口的配置和统计
+    struct PortEntry {
+        int port = 0;
+        BufferProfile profile;
+        LiteralStats c2sLiterals;
+        LiteralStats s2cLiterals;
+    };
+
+    // 按统计结果调整一个方向的缓冲区大小
+    void applyLearning(BufferSizes& sizes, const LiteralStats& stats) const;
+    // 查找端口对应的条目，不存在时返回默认条目
+    const PortEntry& entryFor(int serverPort) const;
+
+    PortEntry defaults;                 // 默认条目（未单独配置且未学习的端口）
+    std::vector<PortEntry> ports;       // 单独配置或学习过的端口，数量很少，线性查找
+    size_t literalCeiling;              // 根据literal扩容时的容量上限
+};
+
+/**
+ * @brief 跟踪一个方向上的IMAP literal，只在literal之外的行尾识别literal声明
+ *
+ * literal声明（{N}\r\n或{N+}\r\n）只出现在行尾，之后的N个字节是literal内容，直接跳过不检查，
+ * 因此邮件正文中形如声明的文本不会被当作literal，扫描也只经过literal之外的命令和响应行。
+ * 尚未结束的行保留最后几个字节，声明被拆到两个数据包中也能识别。
+ */
+class LiteralTracker {
+public:
+    /**
+     * @brief 处理一个数据包的载荷
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param literalSize 找到时写入本数据包中最后一个literal声明的字节数
+     * @return 本数据包中是否有literal声明
+     */
+    bool feed(const char* data, size_t length, size_t& literalSize);
+
+    /**
+     * @brief 获取当前literal尚未到达的字节数，0表示不在literal中
+     */
+    size_t remaining() const noexcept { return literalRemaining; }
+
+    /**
+     * @brief 获取保留的未结束行的最后几个字节（用于保存检查点）
+     */
+    const char* pendingTail() const noexcept { return tail; }
+
+    /**
+     * @brief 获取保留的未结束行的字节数
+     */
+    size_t pendingTailLength() const noexcept { return tailLength; }
+
+    /**
+     * @brief 恢复跟踪状态（用于从检查点恢复流）
+     * @param remaining 当前literal尚未到达的字节数
+     * @param tailData 未结束行的最后几个字节
+     * @param length 未结束行保留的字节数
+     * @return 字节数超过保留上限时返回false，状态不变
+     */
+    bool restore(size_t remaining, const char* tailData, size_t length);
+
+    // 声明的最大长度："{" + 最多12位数字 + "+" + "}" + "\r"
+    static const size_t TAIL_SIZE = 16;
+
+private:
+
+    // 检查以lineEnd（'\n'的位置）结尾的行是否以literal声明结尾，行首部分可能在tail中
+    bool lineEndsWithLiteral(const char* lineStart, const char* lineEnd, size_t& value) const;
+    // 把尚未结束的行的最后几个字节追加到tail
+    void keepTail(const char* begin, const char* end);
+
+    size_t literalRemaining = 0;   // 当前literal尚未到达的字节数
+    char tail[TAIL_SIZE];          // 上一个数据包中尚未结束的行的最后几个字节
+    size_t tailLength = 0;         // tail中的有效字节数
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_BUFFER_SIZING_H
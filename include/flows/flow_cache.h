@@ -0,0 +1,87 @@
+#ifndef FLOW_TABLE_FLOW_CACHE_H
+#define FLOW_TABLE_FLOW_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "flow_key.h"
+
+namespace flow_table {
+
+class Flow;
+
+/**
+ * @brief 最近使用的流的直接映射缓存
+ *
+ * IMAP流量按连接成串到达（一个大的FETCH响应是同一个四元组上连续的几百个数据包），
+ * 查找流索引之前先按哈希值的低位检查一个槽位，命中时只比较一次哈希和键。
+ * 每个流表属于一个工作线程，缓存作为流表的成员也只被该线程访问，不需要同步。
+ * 流被删除时（超时、淘汰、LOGOUT、连接关闭）必须调用invalidate()，缓存中不会留下悬空指针。
+ */
+class FlowCache {
+public:
+    static const size_t SLOTS = 16;   // 槽位数（2的幂）
+
+    FlowCache() { clear(); }
+
+    /**
+     * @brief 查找流
+     * @param key 连接键
+     * @param hash 键的64位哈希值
+     * @return 命中则返回流指针，否则返回nullptr
+     */
+    Flow* find(const FlowKey& key, uint64_t hash) const {
+        const Slot& slot = slots[hash & (SLOTS - 1)];
+        if (slot.flow && slot.hash == hash && slot.key == key) {
+            return slot.flow;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 记录最近使用的流，覆盖同一槽位中原来的流
+     * @param key 连接键
+     * @param hash 键的64位哈希值
+     * @param flow 流指针
+     */
+    void insert(const FlowKey& key, uint64_t hash, Flow* flow) {
+        Slot& slot = slots[hash & (SLOTS - 1)];
+        slot.hash = hash;
+        slot.flow = flow;
+        slot.key = key;
+    }
+
+    /**
+     * @brief 流被删除时移除对它的缓存
+     * @param hash 流的64位哈希值
+     * @param flow 被删除的流
+     */
+    void invalidate(uint64_t hash, const Flow* flow) {
+        Slot& slot = slots[hash & (SLOTS - 1)];
+        if (slot.flow == flow) {
+            slot.flow = nullptr;
+        }
+    }
+
+    /**
+     * @brief 清空缓存
+     */
+    void clear() {
+        for (Slot& slot : slots) {
+            slot.hash = 0;
+            slot.flow = nullptr;
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t hash;      // 完整的64位哈希值
+        Flow* flow;         // 流指针，nullptr表示空槽
+        FlowKey key;        // 内联保存的连接键
+    };
+
+    Slot slots[SLOTS];
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_FLOW_CACHE_H
@@ -0,0 +1,115 @@
+#ifndef FLOW_TABLE_FLOW_INDEX_H
+#define FLOW_TABLE_FLOW_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "flow_key.h"
+
+namespace flow_table {
+
+class Flow;
+
+/**
+ * @brief 开放寻址流索引（Robin Hood哈希）
+ *
+ * 每个槽位内联保存完整的64位哈希值、连接键和流指针，查找时只在连续的槽位数组上
+ * 线性探测，先比较哈希再比较键，避免了基于节点的unordered_multimap的指针追逐。
+ * 删除采用后移（backward shift）方式，不需要墓碑标记。
+ *
+ * 键是规范化的FlowKey（两个方向的四元组生成相同的键），比较只需一次定长的内存比较：
+ * 用任一方向的四元组生成的键都能找到同一个流，数据包无需先把四元组改写为C2S方向。
+ */
+class FlowIndex {
+public:
+    /**
+     * @brief 构造函数
+     * @param initialCapacity 初始槽位数（会向上取整为2的幂）
+     */
+    explicit FlowIndex(size_t initialCapacity = 1024);
+
+    /**
+     * @brief 查找流
+     * @param key 连接键
+     * @param hash 键的64位哈希值
+     * @return 找到则返回流指针，否则返回nullptr
+     */
+    Flow* find(const FlowKey& key, uint64_t hash) const;
+
+    /**
+     * @brief 预取哈希值对应的起始槽位，批量查找时提前发起内存访问
+     * @param hash 键的64位哈希值
+     */
+    void prefetch(uint64_t hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&slots[hash & mask]);
+#else
+        (void)hash;
+#endif
+    }
+
+    /**
+     * @brief 插入流（调用者保证键不存在）
+     * @param key 连接键
+     * @param hash 键的64位哈希值
+     * @param flow 流指针
+     */
+    void insert(const FlowKey& key, uint64_t hash, Flow* flow);
+
+    /**
+     * @brief 删除流
+     * @param key 连接键
+     * @param hash 键的64位哈希值
+     * @return 是否找到并删除
+     */
+    bool erase(const FlowKey& key, uint64_t hash);
+
+    /**
+     * @brief 清空索引（不释放流对象）
+     */
+    void clear();
+
+    /**
+     * @brief 获取索引中的流数量
+     */
+    size_t size() const noexcept { return count; }
+
+    /**
+     * @brief 获取槽位总数
+     */
+    size_t capacity() const noexcept { return slots.size(); }
+
+    /**
+     * @brief 遍历所有流
+     * @param fn 对每个流指针调用的函数
+     */
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (const Slot& slot : slots) {
+            if (slot.dist != 0) {
+                fn(slot.flow);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t hash;      // 完整的64位哈希值
+        Flow* flow;         // 流指针
+        FlowKey key;        // 内联保存的连接键
+        uint32_t dist;      // 探测距离+1，0表示空槽
+    };
+
+    // 扩容为原来的两倍并重新插入所有元素
+    void grow();
+    // 不检查负载因子的插入
+    void insertNoGrow(Slot entry);
+
+    std::vector<Slot> slots;   // 槽位数组，大小为2的幂
+    size_t mask;               // 槽位数-1
+    size_t count;              // 当前元素数量
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_FLOW_INDEX_H
@@ -0,0 +1,93 @@
+#ifndef FLOW_TABLE_FLOW_KEY_H
+#define FLOW_TABLE_FLOW_KEY_H
+
+#include <cstdint>
+#include <cstring>
+#include "../tools/types.h"
+
+namespace flow_table {
+
+/**
+ * @brief 流表内部使用的紧凑规范化连接键
+ *
+ * FourTuple中IP版本、地址联合体和int端口之间有填充，比较时要按IP版本分支并逐字节比较IPv6地址。
+ * FlowKey把两个端点都放进定长的槽位：
+ * - 地址统一为16字节，IPv4存为IPv4映射地址（::ffff:a.b.c.d），未使用的字节为0
+ * - 端口为16位，结构体没有未初始化的填充字节
+ * - 两个端点按（地址、端口、IP版本）排序，同一连接两个方向的四元组得到完全相同的键
+ * 因此判断是否属于同一连接只需比较5个64位字（两个128位地址加一个端口和版本字），
+ * 哈希也总是读取定长的数据，不按IP版本分支。FourTuple仍是流表对外的接口，
+ * 键只在流表内部（索引和最近使用流缓存）由四元组转换得到。
+ */
+struct FlowKey {
+    uint64_t addr[2][2];         // 两个端点的地址（按内存顺序的两个64位字）
+    uint16_t port[2];            // 两个端点的端口
+    uint8_t ipvN[2];             // 两个端点的IP版本 4/6
+    uint8_t reserved[2];         // 保留，总为0
+
+    FlowKey() {
+        memset(this, 0, sizeof(*this));
+    }
+
+    /**
+     * @brief 从任一方向的四元组生成规范化的键
+     * @param fourTuple 四元组
+     */
+    explicit FlowKey(const FourTuple& fourTuple) {
+        uint64_t a0, a1, b0, b1;
+        loadAddress(fourTuple.srcIPvN, fourTuple.srcIPv4, fourTuple.srcIPv6, a0, a1);
+        loadAddress(fourTuple.dstIPvN, fourTuple.dstIPv4, fourTuple.dstIPv6, b0, b1);
+        // 端口和IP版本拼成与内存布局相同的16位+8位整数，参与排序
+        uint32_t metaA = static_cast<uint32_t>(static_cast<uint16_t>(fourTuple.sourcePort)) << 8 | fourTuple.srcIPvN;
+        uint32_t metaB = static_cast<uint32_t>(static_cast<uint16_t>(fourTuple.destPort)) << 8 | fourTuple.dstIPvN;
+        // 较小的端点放在前面，整数比较后用条件传送选择，不逐字节比较
+        bool swapped = a0 != b0 ? a0 > b0 : (a1 != b1 ? a1 > b1 : metaA > metaB);
+        addr[0][0] = swapped ? b0 : a0;
+        addr[0][1] = swapped ? b1 : a1;
+        addr[1][0] = swapped ? a0 : b0;
+        addr[1][1] = swapped ? a1 : b1;
+        uint32_t first = swapped ? metaB : metaA;
+        uint32_t second = swapped ? metaA : metaB;
+        // 端口、IP版本和保留字节一次写入
+        uint64_t meta = static_cast<uint64_t>(first >> 8) | static_cast<uint64_t>(second >> 8) << 16 |
+                        static_cast<uint64_t>(first & 0xff) << 32 | static_cast<uint64_t>(second & 0xff) << 40;
+        memcpy(port, &meta, sizeof(meta));
+    }
+
+    bool operator==(const FlowKey& other) const {
+        // 逐字比较，不分支
+        return ((addr[0][0] ^ other.addr[0][0]) | (addr[0][1] ^ other.addr[0][1]) |
+                (addr[1][0] ^ other.addr[1][0]) | (addr[1][1] ^ other.addr[1][1]) |
+                (metaWord() ^ other.metaWord())) == 0;
+    }
+
+    bool operator!=(const FlowKey& other) const {
+        return !(*this == other);
+    }
+
+private:
+    // 端口、IP版本和保留字节组成的最后一个64位字
+    uint64_t metaWord() const {
+        uint64_t word;
+        memcpy(&word, port, sizeof(word));
+        return word;
+    }
+
+    // 读取地址：IPv6直接读取两个64位字，IPv4转换为IPv4映射地址（::ffff:a.b.c.d，小端序主机上与字节布局一致）
+    static void loadAddress(unsigned char version, unsigned int ipv4, const unsigned char* ipv6,
+                            uint64_t& high, uint64_t& low) {
+        if (version == 6) {
+            memcpy(&high, ipv6, 8);
+            memcpy(&low, ipv6 + 8, 8);
+        } else {
+            high = 0;
+            low = (static_cast<uint64_t>(ipv4) << 32) | 0xffff0000ULL;
+        }
+    }
+};
+
+static_assert(sizeof(FlowKey) == 40, "FlowKey不应包含填充字节");
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_FLOW_KEY_H
@@ -2,24 +2,54 @@
 #define FLOW_TABLE_FLOW_MANAGER_H
 
 #include <string>
+#include <ostream>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 #include <map>
-#include <list>
 #include <ctime>
+#include <memory>
 #include "../tools/types.h"
 #include "../tools/CircularString.h"
+#include "flow_index.h"
+#include "flow_cache.h"
+#include "tuple_hash.h"
+#include "timing_wheel.h"
+#include "time_source.h"
+#include "flow_pool.h"
+#include "buffer_sizing.h"
+#include "flow_stats.h"
 
 namespace flow_table {
 
+/**
+ * @brief 数据包视图，不拥有载荷
+ *
+ * 载荷直接指向调用者的缓冲区（例如TASK::Buffer），处理时只复制一次，直接写入流的环形缓冲区。
+ * 调用者需保证在processPacket()/processBatch()返回前载荷有效。
+ */
+struct PacketView {
+    const char* data = nullptr;                         // 载荷起始地址
+    size_t length = 0;                                  // 载荷长度
+    PacketDirection direction = PacketDirection::C2S;   // 数据包方向
+    FourTuple fourTuple;           // 网络四元组，数据包自身的方向（源端为发送方），也可以是规范化的C2S方向
+    int64_t timestamp = 0;         // 数据包时间戳（毫秒），0表示未提供，仅在数据包时间戳模式下使用
+};
+
 /**
  * @brief 输入数据包结构体，表示一个网络数据包
  */
 struct InputPacket {
     std::string payload;           // 数据包有效载荷
     std::string type;              // 数据包类型(C2S/S2C)，同时表示源角色
-    FourTuple fourTuple;           // 网络四元组，包含源和目标的IP和端口信息
+    FourTuple fourTuple;           // 网络四元组，数据包自身的方向（源端为发送方），也可以是规范化的C2S方向
+    int64_t timestamp = 0;         // 数据包时间戳（毫秒），0表示未提供，仅在数据包时间戳模式下使用
+
+    /**
+     * @brief 转换为指向本数据包载荷的视图
+     * @param view 输出的数据包视图
+     * @return 数据包类型不是C2S/S2C时返回false
+     */
+    bool toView(PacketView& view) const;
 };
 
 /**
@@ -40,18 +70,49 @@ public:
      */
     Flow(const FourTuple& c2sTuple);
 
+    /**
+     * @brief 构造函数（指定缓冲区容量，由流表按自身配置创建流时使用）
+     * @param c2sTuple C2S方向的四元组
+     * @param c2sBufferSize C2S缓冲区容量（字节）
+     * @param s2cBufferSize S2C缓冲区容量（字节）
+     * @param nowMs 创建时间（毫秒），由流表的时钟提供
+     */
+    Flow(const FourTuple& c2sTuple, size_t c2sBufferSize, size_t s2cBufferSize, int64_t nowMs);
+
+    /**
+     * @brief 构造函数（指定两个方向的初始大小和容量上限，由流表按缓冲区大小策略创建流时使用）
+     * @param c2sTuple C2S方向的四元组
+     * @param profile 两个方向的缓冲区大小
+     * @param nowMs 创建时间（毫秒），由流表的时钟提供
+     */
+    Flow(const FourTuple& c2sTuple, const BufferProfile& profile, int64_t nowMs);
+
     /**
      * @brief 向C2S缓冲区添加数据
      * @param data 要添加的数据
      */
     void addC2SData(const std::string& data);
 
+    /**
+     * @brief 向C2S缓冲区添加数据（直接从调用者的缓冲区复制）
+     * @param data 数据起始地址
+     * @param length 数据长度
+     */
+    void addC2SData(const char* data, size_t length);
+
     /**
      * @brief 向S2C缓冲区添加数据
      * @param data 要添加的数据
      */
     void addS2CData(const std::string& data);
 
+    /**
+     * @brief 向S2C缓冲区添加数据（直接从调用者的缓冲区复制）
+     * @param data 数据起始地址
+     * @param length 数据长度
+     */
+    void addS2CData(const char* data, size_t length);
+
     /**
      * @brief 解析C2S缓冲区数据
      * @return 是否检测到 LOGOUT 命令
@@ -69,6 +130,12 @@ public:
      */
     void outputMessages() const;
 
+    /**
+     * @brief 输出流中的消息数据到指定的输出流
+     * @param out 输出流
+     */
+    void outputMessages(std::ostream& out) const;
+
     /**
      * @brief 清理流对象的资源
      */
@@ -79,6 +146,12 @@ public:
      */
     void updateLastActivityTime();
 
+    /**
+     * @brief 更新流的最后活动时间为指定时间
+     * @param nowMs 当前时间（毫秒），由流表的时钟提供
+     */
+    void updateLastActivityTime(int64_t nowMs) { lastActivityTime = nowMs; }
+
     /**
      * @brief 获取流的最后活动时间（毫秒）
      * @return 最后活动时间（毫秒时间戳）
@@ -92,6 +165,16 @@ public:
      */
     bool isTimeout(int64_t timeoutMilliseconds) const;
 
+    /**
+     * @brief 以指定时间为当前时间检查流是否超时
+     * @param timeoutMilliseconds 超时时间（毫秒）
+     * @param nowMs 当前时间（毫秒），由流表的时钟提供
+     * @return 如果流超时返回true，否则返回false
+     */
+    bool isTimeout(int64_t timeoutMilliseconds, int64_t nowMs) const {
+        return (nowMs - lastActivityTime) > timeoutMilliseconds;
+    }
+
     /**
      * @brief 获取C2S方向的四元组
      * @return C2S方向的四元组
@@ -104,7 +187,60 @@ public:
      */
     const FourTuple& getS2CTuple() const { return s2cTuple; }
 
+    /**
+     * @brief 获取两个方向缓冲区实际占用的字节数
+     * @return 缓冲区占用字节数
+     */
+    size_t getBufferBytes() const { return c2sBuffer.memory_usage() + s2cBuffer.memory_usage(); }
+
+    /**
+     * @brief 获取因格式不合法而丢弃的命令或响应行数量
+     * @return 解析错误数量
+     */
+    uint64_t getParseErrors() const { return parseErrors; }
+
+    /**
+     * @brief 获取指定方向缓冲区的容量上限
+     * @param direction 方向
+     * @return 容量上限（字节）
+     */
+    size_t getBufferCapacity(PacketDirection direction) const {
+        return direction == PacketDirection::C2S ? c2sBuffer.cap() : s2cBuffer.cap();
+    }
+
+    /**
+     * @brief 获取指定方向缓冲区中尚未解析的字节数
+     * @param direction 方向
+     * @return 缓冲区中的有效字节数
+     */
+    size_t getBufferedBytes(PacketDirection direction) const {
+        return direction == PacketDirection::C2S ? c2sBuffer.size() : s2cBuffer.size();
+    }
+
+    /**
+     * @brief 获取指定方向的literal跟踪状态
+     * @param direction 方向
+     * @return literal跟踪状态
+     */
+    const LiteralTracker& getLiteralTracker(PacketDirection direction) const {
+        return direction == PacketDirection::C2S ? c2sLiterals : s2cLiterals;
+    }
+
+    /**
+     * @brief 提高指定方向缓冲区的容量上限（只增不减），用于容纳大的literal
+     * @param direction 方向
+     * @param capacity 新的容量上限（字节）
+     */
+    void growBufferCapacity(PacketDirection direction, size_t capacity);
+
 private:
+    friend class HashFlowTable;
+
+    /**
+     * @brief 根据C2S四元组生成S2C方向的四元组
+     */
+    void initS2CTuple();
+
     FourTuple c2sTuple;                    // C2S方向的四元组
     FourTuple s2cTuple;                    // S2C方向的四元组
     std::vector<Message> c2sMessages;      // C2S方向解析出的消息
@@ -114,6 +250,17 @@ private:
     CircularString c2sBuffer;              // C2S方向的数据缓冲区
     CircularString s2cBuffer;              // S2C方向的数据缓冲区
     int64_t lastActivityTime;              // 最后活动时间（毫秒时间戳）
+    uint64_t parseErrors = 0;              // 因格式不合法而丢弃的命令或响应行数量
+    LiteralTracker c2sLiterals;            // C2S方向的literal跟踪，识别literal之外的声明
+    LiteralTracker s2cLiterals;            // S2C方向的literal跟踪
+
+    // 以下字段由HashFlowTable维护，用于O(1)删除
+    uint64_t flowHash;                     // 流在索引中的64位哈希值
+    Flow* lruPrev;                         // 时间排序链表中的前一个流（更旧）
+    Flow* lruNext;                         // 时间排序链表中的后一个流（更新）
+    TimerNode expiryTimer;                 // 超时定时器，挂在流表的时间轮上
+    size_t accountedBytes = 0;             // 已计入流表缓冲区总量的字节数
+    size_t accountedC2SBytes = 0;          // 其中C2S缓冲区的字节数
 };
 
 /**
@@ -133,11 +280,19 @@ public:
 
     /**
      * @brief 根据四元组创建新流或获取已存在的流
-     * @param fourTuple 四元组
+     * @param fourTuple 四元组（新建流时作为C2S方向）
      * @return 流对象指针
      */
     Flow* getOrCreateFlow(const FourTuple& fourTuple);
 
+    /**
+     * @brief 根据任一方向的四元组创建新流或获取已存在的流
+     * @param fourTuple 数据包自身方向的四元组（源端为发送方）
+     * @param fromClient 数据包是否由客户端发出，仅在创建新流时用于确定流的C2S方向
+     * @return 流对象指针
+     */
+    Flow* getOrCreateFlow(const FourTuple& fourTuple, bool fromClient);
+
     /**
      * @brief 向流中添加数据包
      * @param packet 输入数据包
@@ -145,6 +300,34 @@ public:
      */
     bool processPacket(const InputPacket& packet);
 
+    /**
+     * @brief 向流中添加数据包视图，载荷只复制一次（直接写入流的缓冲区）
+     * @param packet 数据包视图
+     * @return 是否成功处理
+     */
+    bool processPacket(const PacketView& packet);
+
+    /**
+     * @brief 批量处理数据包
+     *
+     * 先计算整批数据包的哈希值并预取索引槽位，再查找并预取流对象，最后依次追加数据和解析，
+     * 使多个数据包的缓存未命中相互重叠。Monotonic模式下流表时钟每批只推进一次，
+     * Packet模式下按每个数据包的时间戳推进。处理结果与逐个调用processPacket()相同。
+     *
+     * @param packets 数据包数组
+     * @param count 数据包数量
+     * @return 成功处理的数据包数量
+     */
+    size_t processBatch(const InputPacket* packets, size_t count);
+
+    /**
+     * @brief 批量处理数据包视图，行为同processBatch(const InputPacket*, size_t)
+     * @param packets 数据包视图数组
+     * @param count 数据包数量
+     * @return 成功处理的数据包数量
+     */
+    size_t processBatch(const PacketView* packets, size_t count);
+
     /**
      * @brief 设置流超时时间
      * @param milliseconds 超时时间（毫秒）
@@ -152,9 +335,123 @@ public:
     void setFlowTimeout(int64_t milliseconds);
 
     /**
-     * @brief 检查并清理超时的流
+     * @brief 设置新建流的缓冲区容量（所有端口相同，替换当前的缓冲区大小策略）
+     * @param c2sBufferSize C2S缓冲区容量（字节）
+     * @param s2cBufferSize S2C缓冲区容量（字节）
+     */
+    void setBufferSizes(size_t c2sBufferSize, size_t s2cBufferSize);
+
+    /**
+     * @brief 设置缓冲区大小策略，只影响之后新建的流
+     * @param policy 策略对象，流表取得其所有权；为空时不做修改
+     */
+    void setBufferSizingPolicy(std::unique_ptr<BufferSizingPolicy> policy);
+
+    /**
+     * @brief 获取当前的缓冲区大小策略
+     */
+    const BufferSizingPolicy& getBufferSizingPolicy() const { return *sizingPolicy; }
+
+    /**
+     * @brief 设置超时时间轮的刻度和覆盖范围，只能在流表为空时调用
+     * @param granularityMs 刻度大小（毫秒），即超时判断的精度
+     * @param horizonMs 覆盖范围（毫秒），超出范围的定时器到达范围末端时重新挂入
+     * @return 流表非空时返回false且不做修改
+     */
+    bool setTimingWheel(int64_t granularityMs, int64_t horizonMs);
+
+    /**
+     * @brief 设置流表的时间来源，只能在流表为空时调用
+     * @param mode Monotonic为缓存的粗粒度单调时钟，Packet为数据包携带的时间戳（离线回放）
+     * @return 流表非空时返回false且不做修改
+     */
+    bool setTimeSource(TimeSourceMode mode);
+
+    /**
+     * @brief 设置最大流数量，超出时淘汰最久未活动的流
+     * @param maxFlows 最大流数量，0表示不限制
+     */
+    void setMaxFlows(size_t maxFlows);
+
+    /**
+     * @brief 设置所有流缓冲区的总字节上限，超出时淘汰最久未活动的流
+     * @param maxBufferBytes 总字节上限，0表示不限制
+     */
+    void setMaxBufferBytes(size_t maxBufferBytes);
+
+    /**
+     * @brief 获取因超出流数量或内存上限而被淘汰的流数量
+     * @return 累计淘汰的流数量
+     */
+    uint64_t getEvictedFlows() const { return counters.evictions.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 获取所有流缓冲区当前占用的总字节数
+     * @return 缓冲区总字节数
+     */
+    size_t getBufferBytes() const { return bufferBytes; }
+
+    /**
+     * @brief 获取流表的统计快照，可以在其他线程中调用（不加锁，各项之间不保证来自同一时刻）
+     * @return 统计快照
+     */
+    FlowTableStats getStats() const { return counters.snapshot(); }
+
+    /**
+     * @brief 获取流对象池的占用情况
+     * @return 对象池统计信息（块数量、槽位总数、正在使用的槽位数量）
+     */
+    FlowPoolStats getPoolStats() const { return flowPool.stats(); }
+
+    /**
+     * @brief 推进流表时钟，每批数据包或每个单独处理的数据包调用一次
+     * @param packetTimestampMs 数据包时间戳（毫秒），Monotonic模式下忽略，读取一次单调时钟
+     * @return 推进后的当前时间（毫秒）
+     */
+    int64_t advanceClock(int64_t packetTimestampMs = 0);
+
+    /**
+     * @brief 获取流表时钟的当前时间（毫秒）
+     */
+    int64_t now() const { return timeSource.now(); }
+
+    /**
+     * @brief 检查并清理超时的流（一次处理所有到期的流）
      */
     void checkAndCleanupTimeoutFlows();
+
+    /**
+     * @brief 执行一步超时清理：推进时间轮，最多处理budget个到期的定时器
+     *
+     * 未处理完的到期定时器留在到期链表中，由下一步继续处理，单步的耗时有上限。
+     *
+     * @param budget 本步最多处理的到期定时器数量，0表示不限制
+     * @return 本步删除的流数量
+     */
+    size_t sweepTimeoutFlows(size_t budget);
+
+    /**
+     * @brief 设置由数据包路径驱动的超时清理，两个间隔满足任一个即执行一步
+     * @param everyPackets 每处理多少个数据包执行一步，0表示不按数据包数量触发
+     * @param everyMs 距上一步多少毫秒（流表时钟）后执行一步，0表示不按时间触发
+     * @param budget 每步最多处理的到期定时器数量，0表示不限制
+     */
+    void setSweepPolicy(uint64_t everyPackets, int64_t everyMs, size_t budget);
+
+    /**
+     * @brief 数据包路径上调用：计数一个数据包，到达清理间隔时执行一步超时清理
+     * @return 本次删除的流数量
+     */
+    size_t maybeSweep();
+
+    /**
+     * @brief 获取已到期但尚未处理的定时器数量
+     *
+     * 其中在定时器到期后又有活动的流处理时会重新挂入而不是删除，因此这是待超时删除的流数量的上限。
+     *
+     * @return 等待处理的到期定时器数量
+     */
+    size_t getPendingExpiry() const { return timeWheel.pendingExpired(); }
     
     /**
      * @brief 删除指定的流
@@ -162,6 +459,14 @@ public:
      */
     void deleteFlow(Flow* flow);
 
+    /**
+     * @brief 处理连接关闭：解析缓冲区中剩余的完整命令和响应，输出该流的消息后立即删除流
+     * @param fourTuple 任一方向的四元组
+     * @param out 输出流，写入该流的全部消息
+     * @return 流不存在时返回false（不创建新流）
+     */
+    bool closeFlow(const FourTuple& fourTuple, std::ostream& out);
+
     /**
      * @brief 获取流总数
      * @return 流总数
@@ -173,20 +478,124 @@ public:
      */
     void outputResults() const;
 
+    /**
+     * @brief 输出所有流的处理结果到指定的输出流
+     * @param out 输出流（多线程时每个线程使用自己的输出流，避免重定向全局的std::cout）
+     */
+    void outputResults(std::ostream& out) const;
+
+    /**
+     * @brief 把所有流保存到检查点文件，用于插件重启后恢复
+     *
+     * 保存每个流的四元组、空闲时间、两个方向的容量上限、缓冲区中尚未解析的字节和解析状态；
+     * 已解析出的消息已经输出过，不保存。先写临时文件再改名，失败时不影响已有的检查点文件。
+     *
+     * @param path 检查点文件路径
+     * @return 是否保存成功
+     */
+    bool saveCheckpoint(const std::string& path) const;
+
+    /**
+     * @brief 从检查点文件恢复流，已存在的连接保持当前状态
+     *
+     * 文件以只读方式映射到内存，先完整校验再恢复，缓冲区数据从映射的内存直接复制到流的缓冲区。
+     * 空闲时间按本流表的时钟换算为最后活动时间，超时判断和时间链表顺序与保存时相同。
+     *
+     * @param path 检查点文件路径
+     * @param restoredFlows 恢复的流数量
+     * @return 文件不存在或格式无效时返回false且不恢复任何流
+     */
+    bool restoreCheckpoint(const std::string& path, size_t& restoredFlows);
+
     /**
      * @brief 获取所有流对象的引用
      * @return 所有不重复的流对象的向量
      */
     std::vector<Flow*> getAllFlows();
 
+    /**
+     * @brief 计算四元组的对称哈希值，交换源端和目标端结果不变
+     * @param fourTuple 四元组（任一方向）
+     * @return 64位哈希值
+     */
+    static uint64_t hashFourTuple(const FourTuple& fourTuple);
+
+    /**
+     * @brief 计算连接所属的分片（工作线程），两个方向的数据包属于同一分片
+     * @param fourTuple 四元组（任一方向）
+     * @param shardCount 分片数量
+     * @return 分片编号，范围[0, shardCount)
+     */
+    static unsigned int ownerShard(const FourTuple& fourTuple, unsigned int shardCount);
+
 private:
     /**
-     * @brief 计算四元组的哈希值
-     * @param fourTuple 四元组
-     * @return 哈希值
+     * @brief 使用已计算的键和哈希值查找或创建流
+     * @param fourTuple 四元组（任一方向）
+     * @param key 四元组的连接键
+     * @param hash 键的哈希值
+     * @param fromClient 四元组是否为客户端发往服务器方向
+     * @return 流对象指针
      */
-    int hashFourTuple(const FourTuple& fourTuple) const;
-    
+    Flow* lookupOrCreate(const FourTuple& fourTuple, const FlowKey& key, uint64_t hash, bool fromClient);
+
+    /**
+     * @brief 查找已存在的流，先查最近使用的流缓存，未命中再查索引
+     * @param key 连接键
+     * @param hash 键的哈希值
+     * @return 找到则返回流指针，否则返回nullptr
+     */
+    Flow* findFlow(const FlowKey& key, uint64_t hash);
+
+    /**
+     * @brief 记录已找到的流的一次活动：更新最后活动时间和在时间链表中的位置
+     * @param flow 流指针
+     */
+    void touchFlow(Flow* flow);
+
+    /**
+     * @brief 创建流并加入索引、时间链表和超时时间轮（调用者已确认流不存在）
+     * @param c2sTuple C2S方向的四元组
+     * @param key 四元组的连接键
+     * @param hash 键的哈希值
+     * @param profile 两个方向的缓冲区大小
+     * @param lastActivityMs 流的最后活动时间（毫秒），决定超时定时器的到期时间
+     * @return 流对象指针
+     */
+    Flow* createFlow(const FourTuple& c2sTuple, const FlowKey& key, uint64_t hash, const BufferProfile& profile,
+                     int64_t lastActivityMs);
+
+    /**
+     * @brief 使用已计算的键和哈希值处理数据包（调用者负责推进流表时钟）
+     * @param packet 数据包视图
+     * @param key 数据包四元组的连接键
+     * @param hash 键的哈希值
+     * @param found 调用者已查找到的流（查找之后没有删除过任何流），nullptr表示需要查找或创建
+     * @return 是否成功处理
+     */
+    bool processHashedPacket(const PacketView& packet, const FlowKey& key, uint64_t hash, Flow* found = nullptr);
+
+    /**
+     * @brief 查找数据包中literal之外的literal声明，通知缓冲区大小策略，并在需要时提高该方向缓冲区的容量上限
+     * @param flow 数据包所属的流
+     * @param packet 数据包视图
+     */
+    void observeLiterals(Flow* flow, const PacketView& packet);
+
+    /**
+     * @brief 把解析前后的消息数和解析错误数之差计入统计
+     * @param flow 刚解析过的流
+     * @param messagesBefore 解析前两个方向的消息总数
+     * @param errorsBefore 解析前的解析错误数
+     */
+    void countParsed(const Flow* flow, size_t messagesBefore, uint64_t errorsBefore);
+
+    /**
+     * @brief 批量处理的公共实现（Packet为InputPacket或PacketView）
+     */
+    template <typename Packet>
+    size_t processBatchImpl(const Packet* packets, size_t count);
+
     /**
      * @brief 将流添加到时间排序的链表中
      * @param flow 要添加的流
@@ -205,37 +614,71 @@ private:
      */
     void updateFlowPosition(Flow* flow);
 
-    std::unordered_multimap<int, Flow*> flowMap;               // 流映射表，使用multimap支持哈希冲突
-    std::list<Flow*> timeOrderedFlows;                    // 按时间排序的流列表
-    int64_t flowTimeoutMilliseconds = 120000;              // 默认流超时时间120000毫秒（2分钟）
-    
-    // 时间桶数据结构（用于优化超时检查）
-    using TimeBucket = std::unordered_set<Flow*>;         // 使用unordered_set
-    std::map<int64_t, TimeBucket> timeBuckets;            // 按时间戳映射的流桶（毫秒）
-    const int64_t BUCKET_INTERVAL = 1000;                 // 每个桶的时间间隔（毫秒）
-    
     /**
-     * @brief 添加流到时间桶中
-     * @param flow 要添加的流
-     * @param timestampMs 时间戳（毫秒）
+     * @brief 将流挂到侵入式时间链表的末尾（最新）
+     * @param flow 要挂入的流
      */
-    void addToTimeBucket(Flow* flow, int64_t timestampMs);
-    
+    void linkLruTail(Flow* flow);
+
     /**
-     * @brief 从时间桶中移除流
-     * @param flow 要移除的流
-     * @param timestampMs 原先所在的时间戳（毫秒）
+     * @brief 将流从侵入式时间链表中摘下
+     * @param flow 要摘下的流
      */
-    void removeFromTimeBucket(Flow* flow, int64_t timestampMs);
-    
+    void unlinkLru(Flow* flow);
+
+    /**
+     * @brief 重新统计流的缓冲区占用并更新总量
+     * @param flow 要统计的流
+     */
+    void updateBufferAccounting(Flow* flow);
+
     /**
-     * @brief 移动流到新的时间桶
-     * @param flow 要移动的流
-     * @param oldTimestampMs 原时间戳（毫秒）
-     * @param newTimestampMs 新时间戳（毫秒）
+     * @brief 把两个方向的缓冲区总量写入统计计数器
      */
-    void moveToNewTimeBucket(Flow* flow, int64_t oldTimestampMs, int64_t newTimestampMs);
+    void publishBufferBytes();
 
+    /**
+     * @brief 从最久未活动的流开始淘汰，直到流数量和缓冲区总量都不超过上限
+     * @param keep 不允许被淘汰的流（正在处理的流），可为nullptr
+     */
+    void enforceLimits(const Flow* keep);
+
+    /**
+     * @brief 析构流对象并把内存归还对象池
+     * @param flow 要销毁的流
+     */
+    void destroyFlow(Flow* flow);
+
+    FlowPool flowPool;                                    // 流对象池，创建和删除流不调用通用的malloc/free
+    FlowIndex flowIndex;                                  // 流索引表，开放寻址，内联保存完整哈希和连接键
+    FlowCache flowCache;                                  // 最近使用的流，查找流索引之前先检查
+    Flow* lruHead = nullptr;                              // 侵入式时间链表头（最久未活动的流）
+    Flow* lruTail = nullptr;                              // 侵入式时间链表尾（最近活动的流）
+    int64_t flowTimeoutMilliseconds = 120000;              // 默认流超时时间120000毫秒（2分钟）
+    std::unique_ptr<BufferSizingPolicy> sizingPolicy;     // 缓冲区大小策略，按方向和服务器端口决定新建流的缓冲区大小
+    size_t maxFlows = 0;                                  // 最大流数量，0表示不限制
+    size_t maxBufferBytes = 0;                            // 所有流缓冲区的总字节上限，0表示不限制
+    size_t bufferBytes = 0;                               // 所有流缓冲区当前占用的总字节数
+    size_t c2sBufferBytes = 0;                            // 其中C2S缓冲区占用的字节数
+    FlowTableCounters counters;                           // 统计计数器，其他线程可随时读取
+    uint64_t sweepEveryPackets = 0;                       // 每处理多少个数据包执行一步超时清理，0表示不按数据包数量触发
+    int64_t sweepEveryMs = 0;                             // 距上一步多少毫秒后执行一步超时清理，0表示不按时间触发
+    size_t sweepBudget = 0;                               // 每步最多处理的到期定时器数量，0表示不限制
+    uint64_t packetsSinceSweep = 0;                       // 上一步超时清理之后处理的数据包数量
+    int64_t lastSweepMs = 0;                              // 上一步超时清理的时间（毫秒）
+    uint64_t flowRemovals = 0;                            // 已删除的流数量，批量处理据此判断之前查找到的流指针是否仍然有效
+    
+    // 超时时间轮：每个流内嵌一个定时器节点，挂入/移动/取消均为O(1)
+    TimingWheel timeWheel;
+
+    // 流表时钟：流的活动时间和超时判断都使用缓存的时间，不再每个数据包读取系统时钟
+    TimeSource timeSource;
+
+    /**
+     * @brief 按流的最后活动时间挂入（或重新挂入）超时定时器
+     * @param flow 要挂入的流
+     */
+    void scheduleExpiry(Flow* flow);
 };
 
 } // namespace flow_table
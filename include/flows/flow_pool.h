@@ -0,0 +1,83 @@
+#ifndef FLOW_TABLE_FLOW_POOL_H
+#define FLOW_TABLE_FLOW_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+namespace flow_table {
+
+/**
+ * @brief 对象池统计信息
+ */
+struct FlowPoolStats {
+    size_t slabs = 0;       // 已分配的内存块数量
+    size_t capacity = 0;    // 所有内存块中的对象槽位总数
+    size_t inUse = 0;       // 正在使用的槽位数量
+};
+
+/**
+ * @brief 定长对象池（slab分配器）
+ *
+ * 按块（slab）一次申请多个定长槽位，空闲槽位通过内嵌在槽位中的指针串成空闲链表。
+ * 分配和释放都只是空闲链表的头部操作，不调用通用的malloc/free；
+ * 只有空闲链表为空时才申请一个新块。块在对象池析构前不会归还，
+ * 因此流数量回落后已申请的槽位会留作下次使用（流数量上限由流表的max_flows约束）。
+ *
+ * 对象池只管理内存，不调用构造和析构函数：调用者用placement new在allocate()
+ * 返回的内存上构造对象，销毁时先显式调用析构函数再deallocate()。
+ */
+class FlowPool {
+public:
+    /**
+     * @brief 构造函数
+     * @param objectSize 对象大小（字节）
+     * @param objectAlign 对象对齐要求（字节）
+     * @param objectsPerSlab 每个内存块包含的槽位数量
+     */
+    FlowPool(size_t objectSize, size_t objectAlign, size_t objectsPerSlab = 256);
+
+    /**
+     * @brief 析构函数，释放所有内存块（调用者需保证所有对象已销毁）
+     */
+    ~FlowPool();
+
+    FlowPool(const FlowPool&) = delete;
+    FlowPool& operator=(const FlowPool&) = delete;
+
+    /**
+     * @brief 分配一个槽位
+     * @return 未初始化的对象内存
+     */
+    void* allocate();
+
+    /**
+     * @brief 归还一个槽位
+     * @param ptr allocate()返回的内存（对象已析构）
+     */
+    void deallocate(void* ptr);
+
+    /**
+     * @brief 获取对象池统计信息
+     */
+    FlowPoolStats stats() const;
+
+private:
+    // 空闲槽位的头部用作空闲链表指针
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    // 申请一个新块并把其中的槽位挂入空闲链表
+    void addSlab();
+
+    size_t slotSize;              // 槽位大小（按对齐要求向上取整）
+    size_t slotAlign;             // 槽位对齐要求
+    size_t slotsPerSlab;          // 每块的槽位数量
+    std::vector<void*> slabs;     // 已申请的内存块
+    FreeSlot* freeList;           // 空闲链表头
+    size_t inUse;                 // 正在使用的槽位数量
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_FLOW_POOL_H
@@ -0,0 +1,143 @@
+#ifndef FLOW_TABLE_FLOW_STATS_H
+#define FLOW_TABLE_FLOW_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace flow_table {
+
+/**
+ * @brief 流表统计快照
+ *
+ * 前四项是当前值，其余是自流表创建以来的累计值。多个流表（每个工作线程一个）的快照
+ * 用operator+=汇总：峰值取最大，其余相加。
+ */
+struct FlowTableStats {
+    uint64_t activeFlows = 0;        // 当前流数量
+    uint64_t c2sBufferBytes = 0;     // C2S缓冲区当前占用的存储（字节）
+    uint64_t s2cBufferBytes = 0;     // S2C缓冲区当前占用的存储（字节）
+    uint64_t pendingExpiry = 0;      // 已到期但尚未处理的超时定时器数量（上一步超时清理结束时）
+    uint64_t packets = 0;            // 处理的数据包数量
+    uint64_t cacheLookups = 0;       // 查找流时检查最近使用流缓存的次数
+    uint64_t cacheHits = 0;          // 其中命中缓存、无需查找流索引的次数
+    uint64_t flowsCreated = 0;       // 新建的流数量
+    uint64_t messagesParsed = 0;     // 两个方向解析出的消息数量
+    uint64_t parseErrors = 0;        // 因格式不合法而丢弃的命令或响应行数量
+    uint64_t closes = 0;             // 因连接关闭通告(0x13)删除的流数量
+    uint64_t logoutDeletions = 0;    // 因LOGOUT命令删除的流数量
+    uint64_t timeouts = 0;           // 超时删除的流数量
+    uint64_t evictions = 0;          // 因超出流数量或内存上限而淘汰的流数量
+    uint64_t peakRingBytes = 0;      // 单个环形缓冲区中曾经缓存的最多字节数
+
+    FlowTableStats& operator+=(const FlowTableStats& other) {
+        activeFlows += other.activeFlows;
+        c2sBufferBytes += other.c2sBufferBytes;
+        s2cBufferBytes += other.s2cBufferBytes;
+        pendingExpiry += other.pendingExpiry;
+        packets += other.packets;
+        cacheLookups += other.cacheLookups;
+        cacheHits += other.cacheHits;
+        flowsCreated += other.flowsCreated;
+        messagesParsed += other.messagesParsed;
+        parseErrors += other.parseErrors;
+        closes += other.closes;
+        logoutDeletions += other.logoutDeletions;
+        timeouts += other.timeouts;
+        evictions += other.evictions;
+        if (other.peakRingBytes > peakRingBytes) {
+            peakRingBytes = other.peakRingBytes;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 最近使用流缓存的命中率
+     * @return 命中次数占查找次数的比例，没有查找时返回0
+     */
+    double cacheHitRate() const {
+        return cacheLookups == 0 ? 0.0 : static_cast<double>(cacheHits) / static_cast<double>(cacheLookups);
+    }
+};
+
+/**
+ * @brief 流表计数器
+ *
+ * 每个流表只由所属的工作线程修改，因此更新时用relaxed的读和写代替原子的读-改-写，
+ * 不需要锁前缀指令，开销与普通变量相同；其他线程（例如统计线程）可以随时调用snapshot()读取，
+ * 读到的每一项都是完整的值，但各项之间不保证来自同一时刻。
+ */
+class FlowTableCounters {
+public:
+    /**
+     * @brief 累加一个计数器（只能由流表所属的线程调用）
+     * @param counter 计数器
+     * @param value 增量
+     */
+    static void add(std::atomic<uint64_t>& counter, uint64_t value = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 设置一个当前值（只能由流表所属的线程调用）
+     * @param counter 计数器
+     * @param value 新值
+     */
+    static void set(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 如果value更大则更新峰值（只能由流表所属的线程调用）
+     * @param counter 峰值计数器
+     * @param value 新观察到的值
+     */
+    static void raise(std::atomic<uint64_t>& counter, uint64_t value) {
+        if (value > counter.load(std::memory_order_relaxed)) {
+            counter.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 读取所有计数器（任意线程）
+     * @return 统计快照
+     */
+    FlowTableStats snapshot() const {
+        FlowTableStats stats;
+        stats.activeFlows = activeFlows.load(std::memory_order_relaxed);
+        stats.c2sBufferBytes = c2sBufferBytes.load(std::memory_order_relaxed);
+        stats.s2cBufferBytes = s2cBufferBytes.load(std::memory_order_relaxed);
+        stats.pendingExpiry = pendingExpiry.load(std::memory_order_relaxed);
+        stats.packets = packets.load(std::memory_order_relaxed);
+        stats.cacheLookups = cacheLookups.load(std::memory_order_relaxed);
+        stats.cacheHits = cacheHits.load(std::memory_order_relaxed);
+        stats.flowsCreated = flowsCreated.load(std::memory_order_relaxed);
+        stats.messagesParsed = messagesParsed.load(std::memory_order_relaxed);
+        stats.parseErrors = parseErrors.load(std::memory_order_relaxed);
+        stats.closes = closes.load(std::memory_order_relaxed);
+        stats.logoutDeletions = logoutDeletions.load(std::memory_order_relaxed);
+        stats.timeouts = timeouts.load(std::memory_order_relaxed);
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        stats.peakRingBytes = peakRingBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    std::atomic<uint64_t> activeFlows{0};
+    std::atomic<uint64_t> c2sBufferBytes{0};
+    std::atomic<uint64_t> s2cBufferBytes{0};
+    std::atomic<uint64_t> pendingExpiry{0};
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> cacheLookups{0};
+    std::atomic<uint64_t> cacheHits{0};
+    std::atomic<uint64_t> flowsCreated{0};
+    std::atomic<uint64_t> messagesParsed{0};
+    std::atomic<uint64_t> parseErrors{0};
+    std::atomic<uint64_t> closes{0};
+    std::atomic<uint64_t> logoutDeletions{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> peakRingBytes{0};
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_FLOW_STATS_H
@@ -0,0 +1,86 @@
+#ifndef FLOW_TABLE_TIME_SOURCE_H
+#define FLOW_TABLE_TIME_SOURCE_H
+
+#include <cstdint>
+#include <string>
+
+namespace flow_table {
+
+/**
+ * @brief 时间来源模式
+ */
+enum class TimeSourceMode {
+    Monotonic,  // 粗粒度单调时钟，按批刷新缓存值
+    Packet      // 由数据包携带的时间戳驱动（离线回放）
+};
+
+/**
+ * @brief 流表使用的时钟
+ *
+ * 流表在每个数据包上都需要"当前时间"，直接调用system_clock::now()代价较高，
+ * 且离线回放时超时会跟随墙上时钟而不是抓包时间。本类缓存一个毫秒时间值：
+ * - Monotonic模式下只在refresh()时读取一次粗粒度单调时钟（CLOCK_MONOTONIC_COARSE）
+ * - Packet模式下由observe()传入的数据包时间戳推进
+ * 两种模式下now()都只是读取缓存值，并保证时间不回退。
+ */
+class TimeSource {
+public:
+    /**
+     * @brief 构造函数
+     * @param mode 时间来源模式
+     */
+    explicit TimeSource(TimeSourceMode mode = TimeSourceMode::Monotonic);
+
+    /**
+     * @brief 切换时间来源模式，切换后当前时间重新开始计算
+     * @param mode 时间来源模式
+     */
+    void setMode(TimeSourceMode mode);
+
+    /**
+     * @brief 获取时间来源模式
+     */
+    TimeSourceMode mode() const noexcept { return sourceMode; }
+
+    /**
+     * @brief 获取缓存的当前时间（毫秒）
+     */
+    int64_t now() const noexcept { return nowMs; }
+
+    /**
+     * @brief 刷新缓存时间，Monotonic模式下读取一次单调时钟，Packet模式下不做任何事
+     * @return 刷新后的当前时间（毫秒）
+     */
+    int64_t refresh();
+
+    /**
+     * @brief 用数据包时间戳推进时钟
+     * @param timestampMs 数据包时间戳（毫秒），小于等于0表示数据包未携带时间戳
+     * @return 推进后的当前时间（毫秒）
+     *
+     * Packet模式下时间推进到max(当前时间, timestampMs)，乱序的旧时间戳不会让时间回退；
+     * Monotonic模式下忽略时间戳，等同于refresh()。
+     */
+    int64_t observe(int64_t timestampMs);
+
+    /**
+     * @brief 读取粗粒度单调时钟（毫秒）
+     */
+    static int64_t monotonicMs();
+
+    /**
+     * @brief 解析配置中的时间来源名称
+     * @param name "monotonic"或"packet"
+     * @param mode 解析结果
+     * @return 名称无法识别时返回false
+     */
+    static bool parseMode(const std::string& name, TimeSourceMode& mode);
+
+private:
+    TimeSourceMode sourceMode;  // 时间来源模式
+    int64_t nowMs;              // 缓存的当前时间（毫秒）
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_TIME_SOURCE_H
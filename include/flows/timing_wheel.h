@@ -0,0 +1,134 @@
+#ifndef FLOW_TABLE_TIMING_WHEEL_H
+#define FLOW_TABLE_TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flow_table {
+
+/**
+ * @brief 时间轮定时器节点，侵入式地嵌入到被管理的对象中
+ *
+ * 节点同一时刻只挂在一个槽位（或到期链表）上，挂入、移动、取消都只是
+ * 双向链表的摘链/挂链操作，不分配内存。
+ */
+struct TimerNode {
+    TimerNode* prev = nullptr;   // 链表中的前一个节点
+    TimerNode* next = nullptr;   // 链表中的后一个节点
+    int64_t expireTick = 0;      // 到期刻度
+    void* owner = nullptr;       // 节点所属的对象
+    bool pending = false;        // 是否在到期链表中等待处理
+
+    /**
+     * @brief 节点是否挂在时间轮上
+     */
+    bool isLinked() const noexcept { return next != nullptr; }
+};
+
+/**
+ * @brief 分层时间轮
+ *
+ * 每层64个槽位，第0层每个槽位代表一个刻度（granularity毫秒），第L层每个槽位代表64^L个刻度。
+ * 推进时间时只处理经过的刻度，低层转完一圈时把高层对应槽位的定时器重新分配到低层。
+ * 到期的定时器被移到到期链表中，由调用者通过popExpired()逐个取出处理。
+ * 超出时间范围（horizon）的定时器会被放在最远的位置，提前到期后由调用者重新挂入。
+ */
+class TimingWheel {
+public:
+    /**
+     * @brief 构造函数
+     * @param granularityMs 刻度大小（毫秒）
+     * @param horizonMs 时间轮覆盖的时间范围（毫秒），决定层数
+     */
+    TimingWheel(int64_t granularityMs, int64_t horizonMs);
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    /**
+     * @brief 重新设置刻度大小和覆盖范围，只能在时间轮为空时调用
+     * @param granularityMs 刻度大小（毫秒）
+     * @param horizonMs 时间轮覆盖的时间范围（毫秒）
+     * @return 时间轮非空时返回false且不做修改
+     */
+    bool configure(int64_t granularityMs, int64_t horizonMs);
+
+    /**
+     * @brief 设置时间轮的当前时间，只能在时间轮为空时调用
+     * @param nowMs 当前时间（毫秒）
+     */
+    void reset(int64_t nowMs);
+
+    /**
+     * @brief 挂入或移动定时器
+     * @param node 定时器节点（如已挂在时间轮上则先摘下）
+     * @param expireMs 到期时间（毫秒）
+     */
+    void schedule(TimerNode* node, int64_t expireMs);
+
+    /**
+     * @brief 取消定时器
+     * @param node 定时器节点（未挂入时什么也不做）
+     */
+    void cancel(TimerNode* node);
+
+    /**
+     * @brief 推进时间，把到期的定时器移入到期链表
+     * @param nowMs 当前时间（毫秒），早于时间轮当前时间时不做任何事
+     */
+    void advance(int64_t nowMs);
+
+    /**
+     * @brief 从到期链表中取出一个定时器
+     * @return 到期的定时器节点，没有则返回nullptr
+     */
+    TimerNode* popExpired();
+
+    /**
+     * @brief 获取到期链表中等待处理的定时器数量
+     */
+    size_t pendingExpired() const noexcept { return expiredCount; }
+
+    /**
+     * @brief 获取时间轮上（不含到期链表）的定时器数量
+     */
+    size_t scheduledCount() const noexcept { return scheduled; }
+
+    /**
+     * @brief 获取刻度大小（毫秒）
+     */
+    int64_t granularity() const noexcept { return granularityMs; }
+
+    /**
+     * @brief 获取时间轮覆盖的时间范围（毫秒）
+     */
+    int64_t horizon() const noexcept { return maxTicks * granularityMs; }
+
+private:
+    static const int SLOT_BITS = 6;
+    static const int64_t SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+    static const int64_t SLOT_MASK = SLOTS_PER_LEVEL - 1;
+
+    // 链表操作（链表头为哨兵节点）
+    static void linkBefore(TimerNode* head, TimerNode* node);
+    static void unlink(TimerNode* node);
+
+    // 根据到期刻度把节点挂入合适的层和槽位
+    void place(TimerNode* node);
+    // 把高层某个槽位中的定时器重新分配到低层
+    void cascade(int level, int64_t index);
+
+    int64_t granularityMs;              // 刻度大小（毫秒）
+    int levels;                         // 层数
+    int64_t maxTicks;                   // 可表示的最大刻度差
+    int64_t currentTick;                // 当前刻度
+    std::vector<TimerNode> slots;       // 所有层的槽位哨兵，按层连续存放
+    TimerNode expired;                  // 到期链表哨兵
+    size_t scheduled;                   // 时间轮上的定时器数量
+    size_t expiredCount;                // 到期链表中的定时器数量
+};
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_TIMING_WHEEL_H
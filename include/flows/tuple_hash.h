@@ -0,0 +1,62 @@
+#ifndef FLOW_TABLE_TUPLE_HASH_H
+#define FLOW_TABLE_TUPLE_HASH_H
+
+#include <cstdint>
+#include "../tools/types.h"
+#include "flow_key.h"
+
+namespace flow_table {
+
+/**
+ * @brief 四元组哈希的实现方式
+ */
+enum class TupleHashKind {
+    Portable,   // 乘法-异或移位混合，任何平台可用
+    Crc32c      // 硬件CRC32C指令（x86 SSE4.2或ARMv8 CRC扩展）
+};
+
+/**
+ * @brief 计算连接键的64位哈希值
+ *
+ * 键中两个端点各自按定长的16字节地址和端口计算64位的端点哈希，按键中的顺序组合，再经过一次64位最终混合，
+ * 低位和高位都均匀分布：流索引使用低位，分片使用高位。
+ * CPU支持时使用硬件CRC32C计算端点哈希，否则使用便携实现。同一进程内实现固定不变，
+ * 但不同机器上的哈希值可能不同，哈希值不能保存到文件中（检查点恢复时重新计算）。
+ * @param key 连接键
+ * @return 64位哈希值
+ */
+uint64_t hashFlowKey(const FlowKey& key);
+
+/**
+ * @brief 使用指定实现计算连接键的哈希（用于测试和性能比较）
+ * @param key 连接键
+ * @param kind 哈希实现，当前CPU不支持时使用便携实现
+ * @return 64位哈希值
+ */
+uint64_t hashFlowKey(const FlowKey& key, TupleHashKind kind);
+
+/**
+ * @brief 计算四元组的对称64位哈希值，等于其连接键的哈希值
+ *
+ * 同一连接两个方向的四元组得到相同的键，因此哈希值相同，两个方向的数据包落在同一个索引槽位和同一个工作线程。
+ * @param fourTuple 四元组（任一方向）
+ * @return 64位哈希值
+ */
+uint64_t hashTuple(const FourTuple& fourTuple);
+
+/**
+ * @brief 使用指定实现计算四元组哈希（用于测试和性能比较）
+ * @param fourTuple 四元组（任一方向）
+ * @param kind 哈希实现，当前CPU不支持时使用便携实现
+ * @return 64位哈希值
+ */
+uint64_t hashTuple(const FourTuple& fourTuple, TupleHashKind kind);
+
+/**
+ * @brief 获取hashTuple()使用的实现（运行时检测一次）
+ */
+TupleHashKind activeTupleHash();
+
+} // namespace flow_table
+
+#endif // FLOW_TABLE_TUPLE_HASH_H
@@ -22,15 +22,19 @@
 #endif
 
 // 插件相关宏定义
+// 支持的最大工作线程数，TASK::Thread必须小于该值（每个线程一个流表）
+#define PLUGIN_MAX_THREADS 256
 
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
 #include <arpa/inet.h>
 #include <fstream>
 #include <sstream>
 #include <unistd.h>
 #include <limits.h>
+#include <chrono>
 #include "../flows/flow_manager.h"
 #include "../tools/CircularString.h"
 #include "../tools/types.h"
@@ -99,9 +103,11 @@ DLL_PUBLIC int Create(unsigned short Version, unsigned short Amount, const char
  * 
  * 该函数在每个工作线程启动时执行，用于初始化线程级别资源
  * 
- * @param Thread 线程编号
+ * 每个线程拥有独立的流表，重复调用会重新创建该线程的流表
+ * 
+ * @param Thread 线程编号，必须小于PLUGIN_MAX_THREADS
  * @param Option 选项参数
- * @return 初始化结果，0表示成功
+ * @return 初始化结果，0表示成功，线程编号超出范围时返回-1
  */
 DLL_PUBLIC int Single(unsigned short Thread, const char *Option);
 
@@ -109,6 +115,8 @@ DLL_PUBLIC int Single(unsigned short Thread, const char *Option);
  * @brief 数据过滤函数
  * 
  * 处理每个数据包，解析IMAP协议内容并进行关键词检测
+ * 连接关闭通告(0x13)时解析剩余的完整消息，然后立即释放该连接的流
+ * 按Import->Thread选择该线程的流表，不同线程可以并发调用
  * 
  * @param Import 输入的数据包任务
  * @param Export 输出的数据包任务
@@ -119,7 +127,7 @@ DLL_PUBLIC int Filter(TASK *Import, TASK **Export);
 /**
  * @brief 插件拆除函数 (资源清理)
  * 
- * 负责释放所有资源
+ * 负责释放所有资源，包括所有线程的流表
  */
 DLL_PUBLIC void Remove();
 
@@ -131,6 +139,28 @@ DLL_PUBLIC void Remove();
  */
 DLL_PUBLIC void SetConfigFilePath(const char* path);
 
+/**
+ * @brief 计算数据包所属的工作线程
+ * 
+ * 与流表使用同一个对称哈希，同一连接两个方向的数据包得到相同的线程编号，
+ * 上游分发器可以据此把数据包交给对应线程的Filter，无需先规范化方向
+ * 
+ * @param Import 输入的数据包任务
+ * @param Threads 工作线程数量
+ * @return 线程编号，范围[0, Threads)
+ */
+DLL_PUBLIC unsigned short OwnerThread(const TASK *Import, unsigned short Threads);
+
+/**
+ * @brief 获取所有线程流表的汇总统计
+ * 
+ * 可以在工作线程调用Filter的同时从其他线程调用，不加锁；
+ * 不能与Single或Remove同时调用（二者会创建或删除流表）
+ * 
+ * @param Stats 输出的统计信息：峰值取所有线程的最大值，其余各项为所有线程之和
+ */
+DLL_PUBLIC void GetFlowStats(flow_table::FlowTableStats *Stats);
+
 #ifdef __cplusplus
 }
 #endif
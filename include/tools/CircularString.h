@@ -5,32 +5,69 @@
 #include <string>
 #include <stdexcept>
 #include <algorithm>
+#include "substring_searcher.h"
 
 /**
  * @brief 环形字符串类，用于高效管理固定容量的字符缓冲区
  *
  * 该类实现了一个环形缓冲区，当缓冲区满时，新添加的元素会覆盖最旧的元素。
  * 主要用于需要保留最近N个字符的场景，如日志记录、数据流处理等。
+ *
+ * 底层存储按需分配：构造时不分配内存，写入数据时按2倍增长，直到容量上限，
+ * 之后才开始覆盖最旧的元素。因此大容量上限的空闲缓冲区几乎不占用内存。
+ *
+ * 可选的镜像存储（Linux）：用memfd创建一段共享内存，在虚拟地址空间中紧挨着映射两次，
+ * 环形存储在内存中看起来连续出现两遍，任意逻辑范围[m, n]都是一段连续内存（见contiguous()），
+ * 查找和解析可以直接使用memchr等按内存块处理的函数，不需要分两段或逐字节经过at()。
+ * 映射以页为单位，存储大小向上取整到页大小的倍数；取整后超过容量上限（容量上限不是页大小的倍数）、
+ * 不支持memfd的平台或映射失败时，使用普通的堆存储。每个镜像存储占用两个内存映射区域，
+ * 大量流同时使用时需要注意系统的映射数量上限（vm.max_map_count）。
  */
 class CircularString {
 private:
-    std::vector<char> buffer;  // 底层存储
-    size_t capacity;           // 缓冲区总容量
+    static const size_t INITIAL_STORAGE = 256;  // 默认的首次分配底层存储大小
+
+    std::vector<char> buffer;  // 堆存储（未使用镜像存储时），大小在[0, capacity]之间按需增长
+    char* mirror;              // 镜像存储的起始地址（2 * storage字节的映射），未使用时为nullptr
+    char* base;                // 当前底层存储的起始地址（buffer.data()或mirror）
+    size_t storage;            // 当前底层存储的大小
+    size_t capacity;           // 缓冲区容量上限
+    size_t initial_storage;    // 首次分配的底层存储大小
+    bool mirror_requested;     // 是否尽量使用镜像存储
     size_t head;               // 逻辑起始位置（物理索引）
     size_t count;              // 当前有效元素数量
 
+    // 保证底层存储至少能容纳required个元素（不超过容量上限），增长时把数据整理为从0开始
+    void reserve_storage(size_t required);
+    // 换用new_size字节的新存储（可能时使用镜像存储），把有效数据整理为从0开始，释放原存储
+    void replace_storage(size_t new_size);
+    // 把逻辑范围[m, m + length)复制到dest（最多两段）
+    void copy_range(size_t m, size_t length, char* dest) const;
+    // 释放镜像存储
+    void release_mirror() noexcept;
+    void swap(CircularString& other) noexcept;
+
     // 将逻辑索引转换为物理索引
     size_t physical_index(size_t logical_index) const;
     // 将物理索引转换为逻辑索引
     size_t logical_index(size_t physical_index) const;
 
 public:
+    static const size_t npos = static_cast<size_t>(-1);  // 查找失败时的返回值
+
     /**
-     * @brief 构造函数，创建指定容量的环形字符串
-     * @param size 环形缓冲区的容量
+     * @brief 构造函数，创建指定容量的环形字符串（不立即分配底层存储）
+     * @param size 环形缓冲区的容量上限
+     * @param initial 首次写入时分配的底层存储大小（不超过容量上限）
+     * @param mirrored 是否尽量使用镜像存储，条件不满足时仍使用堆存储
      * @throw std::invalid_argument 如果容量为0
      */
-    explicit CircularString(size_t size);
+    explicit CircularString(size_t size, size_t initial = INITIAL_STORAGE, bool mirrored = false);
+
+    CircularString(const CircularString& other);
+    CircularString(CircularString&& other) noexcept;
+    CircularString& operator=(CircularString other) noexcept;
+    ~CircularString();
 
     /**
      * @brief 在末尾插入字符串
@@ -38,6 +75,13 @@ public:
      */
     void push_back(const std::string& str);
 
+    /**
+     * @brief 在末尾插入一段字节（直接从调用者的缓冲区复制到环形存储，不经过临时字符串）
+     * @param data 数据起始地址
+     * @param length 数据长度
+     */
+    void push_back(const char* data, size_t length);
+
     /**
      * @brief 查找第n次出现的字符串（从1开始计数）
      * @param target 要查找的字符串
@@ -47,6 +91,25 @@ public:
      */
     size_t find_nth(const std::string& target, size_t n) const;
 
+    /**
+     * @brief 使用预编译的查找器查找第n次出现的字符串（从1开始计数，出现位置可以重叠）
+     * @param searcher 查找器，可以在多次查找之间复用
+     * @param n 第几次出现
+     * @return 目标字符串第n次出现的首字符逻辑索引
+     * @throw std::out_of_range 如果字符串没有出现足够次数
+     */
+    size_t find_nth(const SubstringSearcher& searcher, size_t n) const;
+
+    /**
+     * @brief 从start_index开始查找目标字符串第一次出现的位置（可以跨过存储末尾）
+     *
+     * 直接在内存段上查找，不复制缓冲区；跨过堆存储末尾的出现位置只复制末尾前后各不超过目标长度的字节来检查。
+     * @param searcher 查找器
+     * @param start_index 起始索引（包含）
+     * @return 目标字符串首字符的逻辑索引，没有找到时返回npos
+     */
+    size_t search(const SubstringSearcher& searcher, size_t start_index = 0) const;
+
     /**
      * @brief 获取子字符串[m, n]
      * @param m 起始索引（包含）
@@ -56,6 +119,108 @@ public:
      */
     std::string substring(size_t m, size_t n) const;
 
+    /**
+     * @brief 获取逻辑范围[m, n]的连续内存
+     *
+     * 使用镜像存储时任意范围都是连续的；堆存储中只有不跨过存储末尾的范围是连续的。
+     * 返回的指针在下一次写入、删除或扩容之前有效。
+     * @param m 起始索引（包含）
+     * @param n 结束索引（包含）
+     * @return 指向第m个元素的指针，范围跨过堆存储末尾时返回nullptr
+     * @throw std::out_of_range 如果索引范围无效
+     */
+    const char* contiguous(size_t m, size_t n) const;
+
+    /**
+     * @brief 环形存储中的一段连续内存
+     */
+    struct Segment {
+        const char* data;   // 起始地址
+        size_t length;      // 字节数
+    };
+
+    /**
+     * @brief 获取逻辑范围[m, n]对应的连续内存段，不复制数据
+     *
+     * 范围跨过堆存储末尾时分为两段，否则（包括镜像存储中的任意范围）只有一段。
+     * 指针在下一次写入、删除或扩容之前有效。
+     * @param m 起始索引（包含）
+     * @param n 结束索引（包含）
+     * @param out 输出的内存段，按逻辑顺序排列，至少能容纳两段
+     * @return 段数（1或2）
+     * @throw std::out_of_range 如果索引范围无效
+     */
+    size_t segments(size_t m, size_t n, Segment out[2]) const;
+
+    /**
+     * @brief 把逻辑范围[m, n]追加到字符串末尾（按段整块复制，不逐字节读取）
+     * @param out 目标字符串
+     * @param m 起始索引（包含）
+     * @param n 结束索引（包含）
+     * @throw std::out_of_range 如果索引范围无效
+     */
+    void append_to(std::string& out, size_t m, size_t n) const;
+
+    /**
+     * @brief 按逻辑顺序读取一个范围的读取器
+     *
+     * 可以逐段读取，也可以逐字节读取；逐字节读取只在段内移动指针，不计算取模也不检查索引。
+     * 读取器保存的是内存段的指针，在环形字符串下一次写入、删除或扩容之前有效。
+     */
+    class Reader {
+    public:
+        /**
+         * @brief 构造读取逻辑范围[m, n]的读取器
+         * @param ring 环形字符串
+         * @param m 起始索引（包含）
+         * @param n 结束索引（包含）
+         * @throw std::out_of_range 如果索引范围无效
+         */
+        Reader(const CircularString& ring, size_t m, size_t n);
+
+        /**
+         * @brief 读取当前段中剩余的全部字节
+         * @param segment 输出的内存段
+         * @return 没有剩余数据时返回false
+         */
+        bool next_segment(Segment& segment);
+
+        /**
+         * @brief 读取下一个字节
+         * @param c 输出的字节
+         * @return 没有剩余数据时返回false
+         */
+        bool next(char& c) {
+            while (part < part_count) {
+                if (offset < parts[part].length) {
+                    c = parts[part].data[offset++];
+                    return true;
+                }
+                ++part;
+                offset = 0;
+            }
+            return false;
+        }
+
+        /**
+         * @brief 获取尚未读取的字节数
+         * @return 剩余字节数
+         */
+        size_t remaining() const noexcept;
+
+    private:
+        Segment parts[2];     // 范围对应的内存段
+        size_t part_count;    // 段数
+        size_t part;          // 当前段
+        size_t offset;        // 当前段中已读取的字节数
+    };
+
+    /**
+     * @brief 当前底层存储是否为镜像存储
+     * @return 是镜像存储时返回true（尚未分配存储时返回false）
+     */
+    bool is_mirrored() const noexcept;
+
     /**
      * @brief 删除k及之前的所有元素
      * @param k 要删除的最后一个元素的索引
@@ -70,11 +235,23 @@ public:
     size_t size() const noexcept;
 
     /**
-     * @brief 获取缓冲区总容量
-     * @return 缓冲区容量
+     * @brief 获取缓冲区容量上限
+     * @return 缓冲区容量上限
      */
     size_t cap() const noexcept;
 
+    /**
+     * @brief 提高缓冲区容量上限（只增不减），之后的写入可以继续增长底层存储而不覆盖旧元素
+     * @param new_capacity 新的容量上限，不大于当前上限时不做任何事
+     */
+    void grow_capacity(size_t new_capacity);
+
+    /**
+     * @brief 获取底层存储实际占用的字节数
+     * @return 已分配的字节数
+     */
+    size_t memory_usage() const noexcept;
+
     /**
      * @brief 根据索引获取元素值
      * @param index 索引值
@@ -92,6 +269,16 @@ public:
      * @throw std::out_of_range 如果索引范围无效
      */
     size_t find(size_t start_index, size_t end_index, const char target);
+
+    /**
+     * @brief 从start_index开始查找第一个完整的"\r\n"（可以跨过存储末尾）
+     *
+     * 按内存段使用SIMD查找（见scan_crlf()），不经过at()，也不抛出异常：
+     * 数据还不完整（没有换行符，或'\r'是最后一个字节）时返回npos，调用者等待更多数据即可。
+     * @param start_index 起始索引（包含），不小于size()时返回npos
+     * @return '\r'的索引，没有找到时返回npos
+     */
+    size_t find_crlf(size_t start_index = 0) const noexcept;
 };
 
 #endif // CIRCULAR_STRING_H
\ No newline at end of file
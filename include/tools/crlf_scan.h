@@ -0,0 +1,40 @@
+#ifndef CRLF_SCAN_H
+#define CRLF_SCAN_H
+
+#include <cstddef>
+
+/**
+ * @brief CRLF查找的实现方式
+ */
+enum class CrlfScanKind {
+    Scalar,     // 逐字节查找，任何平台可用
+    Sse2,       // 每次比较16字节（x86-64）
+    Avx2        // 每次比较32字节（x86-64，运行时检测CPU支持）
+};
+
+/**
+ * @brief 在一段连续内存中查找第一个"\r\n"
+ *
+ * 每次把一个数据块与'\r'比较、把错开一个字节的数据块与'\n'比较，两个结果按位与后取第一个置位的位置，
+ * 不需要先找'\r'再逐个检查下一个字节。CPU支持时使用AVX2，否则在x86-64上使用SSE2，其他平台逐字节查找。
+ * @param data 数据起始地址
+ * @param length 数据长度
+ * @return '\r'相对data的偏移，没有完整的"\r\n"时返回length
+ */
+size_t scan_crlf(const char* data, size_t length);
+
+/**
+ * @brief 使用指定实现查找第一个"\r\n"（用于测试和性能比较）
+ * @param data 数据起始地址
+ * @param length 数据长度
+ * @param kind 查找实现，当前CPU不支持时使用可用的最快实现
+ * @return '\r'相对data的偏移，没有完整的"\r\n"时返回length
+ */
+size_t scan_crlf(const char* data, size_t length, CrlfScanKind kind);
+
+/**
+ * @brief 获取scan_crlf()使用的实现（运行时检测一次）
+ */
+CrlfScanKind active_crlf_scan();
+
+#endif // CRLF_SCAN_H
@@ -0,0 +1,53 @@
+#ifndef SUBSTRING_SEARCHER_H
+#define SUBSTRING_SEARCHER_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief 预编译的子字符串查找器
+ *
+ * 构造时为目标字符串建立一次Sunday算法的坏字符表（256项的数组，按字节值直接索引），
+ * 之后可以反复用于查找，适合MIME边界、literal结尾这类在每个数据包中反复查找的固定字符串。
+ * 查找时在x86-64上先用SSE2每次检查16个位置的首字节和末字节，两者都相等的位置才比较中间部分，
+ * 剩余不足一个数据块的部分和其他平台使用Sunday算法。
+ * 查找器只读，可以被多个环形字符串和多个线程同时使用（见CircularString::search()）。
+ */
+class SubstringSearcher {
+public:
+    static const size_t npos = static_cast<size_t>(-1);  // 没有找到时的返回值
+
+    /**
+     * @brief 构造函数，为目标字符串建立坏字符表
+     * @param needle 目标字符串
+     * @throw std::invalid_argument 如果目标字符串为空
+     */
+    explicit SubstringSearcher(const std::string& needle);
+
+    /**
+     * @brief 获取目标字符串
+     * @return 目标字符串
+     */
+    const std::string& needle() const noexcept { return pattern; }
+
+    /**
+     * @brief 获取目标字符串的长度
+     * @return 目标字符串的字节数
+     */
+    size_t size() const noexcept { return pattern.size(); }
+
+    /**
+     * @brief 在一段连续内存中查找目标字符串第一次出现的位置
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param from 开始查找的偏移
+     * @return 目标字符串首字节相对data的偏移，没有找到时返回npos
+     */
+    size_t find(const char* data, size_t length, size_t from = 0) const noexcept;
+
+private:
+    std::string pattern;   // 目标字符串
+    size_t shift[256];     // 坏字符表：窗口之后的字节为c时窗口向后移动的距离
+};
+
+#endif // SUBSTRING_SEARCHER_H
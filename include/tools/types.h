@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
 
 /**
  * @brief 消息结构体，表示IMAP命令或响应
@@ -191,6 +194,29 @@ struct FourTuple {
         
         return true;
     }
+
+    /**
+     * @brief 生成反方向的四元组（源和目标互换）
+     */
+    FourTuple reversed() const {
+        FourTuple result;
+        memset(&result, 0, sizeof(result));
+        result.srcIPvN = dstIPvN;
+        result.dstIPvN = srcIPvN;
+        if (dstIPvN == 4) {
+            result.srcIPv4 = dstIPv4;
+        } else if (dstIPvN == 6) {
+            memcpy(result.srcIPv6, dstIPv6, 16);
+        }
+        if (srcIPvN == 4) {
+            result.dstIPv4 = srcIPv4;
+        } else if (srcIPvN == 6) {
+            memcpy(result.dstIPv6, srcIPv6, 16);
+        }
+        result.sourcePort = destPort;
+        result.destPort = sourcePort;
+        return result;
+    }
 };
 
 #endif // FLOW_TABLE_TYPES_H
\ No newline at end of file
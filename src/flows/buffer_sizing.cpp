@@ -0,0 +1,228 @@
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "../../include/flows/buffer_sizing.h"
+
+namespace flow_table {
+
+// 按统计结果提高首次分配大小时的上限，避免每个新流一开始就分配很大的存储
+static const size_t MAX_LEARNED_INITIAL = 1024 * 1024;
+// 最多单独统计的端口数量，其余端口的统计计入默认条目
+static const size_t MAX_LEARNED_PORTS = 64;
+// literal字节数最多的十进制位数，超出视为无效
+static const size_t MAX_LITERAL_DIGITS = 12;
+
+// 向上取整为2的幂
+static size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+PortBufferSizingPolicy::PortBufferSizingPolicy(const BufferProfile& defaults, size_t literalCeiling)
+    : literalCeiling(literalCeiling) {
+    this->defaults.port = -1;
+    this->defaults.profile = defaults;
+}
+
+void PortBufferSizingPolicy::setPortProfile(int serverPort, const BufferProfile& profile) {
+    for (PortEntry& entry : ports) {
+        if (entry.port == serverPort) {
+            entry.profile = profile;
+            return;
+        }
+    }
+    PortEntry entry;
+    entry.port = serverPort;
+    entry.profile = profile;
+    ports.push_back(entry);
+}
+
+const PortBufferSizingPolicy::PortEntry& PortBufferSizingPolicy::entryFor(int serverPort) const {
+    for (const PortEntry& entry : ports) {
+        if (entry.port == serverPort) {
+            return entry;
+        }
+    }
+    return defaults;
+}
+
+BufferProfile PortBufferSizingPolicy::profileFor(int serverPort) const {
+    const PortEntry& entry = entryFor(serverPort);
+    BufferProfile profile = entry.profile;
+    // 是否使用镜像存储是全局设置，单独配置的端口也沿用默认条目的值
+    profile.mirrored = defaults.profile.mirrored;
+    applyLearning(profile.c2s, entry.c2sLiterals);
+    applyLearning(profile.s2c, entry.s2cLiterals);
+    return profile;
+}
+
+void PortBufferSizingPolicy::applyLearning(BufferSizes& sizes, const LiteralStats& stats) const {
+    if (stats.samples == 0) {
+        return;
+    }
+    // 容量上限至少能容纳见过的最大literal（不超过literal上限）
+    if (literalCeiling > 0) {
+        size_t learnedMaximum = std::min(stats.peak + LITERAL_HEADROOM, literalCeiling);
+        sizes.maximum = std::max(sizes.maximum, learnedMaximum);
+    }
+    // 首次分配的存储能容纳典型大小的literal，减少逐步倍增时的复制
+    size_t learnedInitial = roundUpPowerOfTwo(stats.average + LITERAL_HEADROOM);
+    learnedInitial = std::min(std::min(learnedInitial, MAX_LEARNED_INITIAL), sizes.maximum);
+    sizes.initial = std::max(sizes.initial, learnedInitial);
+}
+
+size_t PortBufferSizingPolicy::observeLiteral(int serverPort, PacketDirection direction, size_t literalSize) {
+    PortEntry* entry = nullptr;
+    for (PortEntry& candidate : ports) {
+        if (candidate.port == serverPort) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        if (ports.size() < MAX_LEARNED_PORTS) {
+            // 未单独配置的端口沿用默认大小，只是单独统计
+            PortEntry learned;
+            learned.port = serverPort;
+            learned.profile = defaults.profile;
+            ports.push_back(learned);
+            entry = &ports.back();
+        } else {
+            entry = &defaults;
+        }
+    }
+
+    LiteralStats& stats = direction == PacketDirection::C2S ? entry->c2sLiterals : entry->s2cLiterals;
+    if (stats.samples == 0) {
+        stats.average = literalSize;
+    } else {
+        stats.average = stats.average - stats.average / 8 + literalSize / 8;
+    }
+    stats.peak = std::max(stats.peak, literalSize);
+    ++stats.samples;
+
+    return literalCeiling;
+}
+
+bool PortBufferSizingPolicy::parseProfile(const std::string& text, BufferProfile& profile) {
+    size_t values[4];
+    size_t count = 0;
+    size_t start = 0;
+    while (start <= text.size() && count < 4) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string field = text.substr(start, end - start);
+        field.erase(0, field.find_first_not_of(" \t"));
+        field.erase(field.find_last_not_of(" \t") + 1);
+        if (field.empty() || field.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        values[count++] = static_cast<size_t>(std::strtoull(field.c_str(), nullptr, 10));
+        start = end + 1;
+    }
+    if (count != 4 || start <= text.size()) {
+        return false;
+    }
+    if (values[0] == 0 || values[1] == 0 || values[2] == 0 || values[3] == 0) {
+        return false;
+    }
+    profile.c2s.initial = values[0];
+    profile.c2s.maximum = values[1];
+    profile.s2c.initial = values[2];
+    profile.s2c.maximum = values[3];
+    return true;
+}
+
+const size_t LiteralTracker::TAIL_SIZE;
+
+bool LiteralTracker::feed(const char* data, size_t length, size_t& literalSize) {
+    bool found = false;
+    const char* cursor = data;
+    const char* end = data + length;
+    while (cursor < end) {
+        // literal内容直接跳过
+        if (literalRemaining > 0) {
+            size_t skip = std::min(literalRemaining, static_cast<size_t>(end - cursor));
+            cursor += skip;
+            literalRemaining -= skip;
+            continue;
+        }
+        const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) {
+            keepTail(cursor, end);
+            break;
+        }
+        size_t value = 0;
+        if (lineEndsWithLiteral(cursor, lineEnd, value)) {
+            literalSize = value;
+            literalRemaining = value;
+            found = true;
+        }
+        tailLength = 0;
+        cursor = lineEnd + 1;
+    }
+    return found;
+}
+
+bool LiteralTracker::lineEndsWithLiteral(const char* lineStart, const char* lineEnd, size_t& value) const {
+    // 取行尾最多TAIL_SIZE个字节（不含'\n'），不足时从上一个数据包保留的部分补齐
+    char suffix[TAIL_SIZE];
+    size_t inPacket = std::min(static_cast<size_t>(lineEnd - lineStart), TAIL_SIZE);
+    size_t fromTail = std::min(tailLength, TAIL_SIZE - inPacket);
+    memcpy(suffix, tail + tailLength - fromTail, fromTail);
+    memcpy(suffix + fromTail, lineEnd - inPacket, inPacket);
+    size_t n = fromTail + inPacket;
+
+    // 从后向前匹配 {数字[+]}\r
+    if (n < 4 || suffix[n - 1] != '\r' || suffix[n - 2] != '}') {
+        return false;
+    }
+    size_t pos = n - 2;
+    if (suffix[pos - 1] == '+') {
+        --pos;
+    }
+    size_t digitsEnd = pos;
+    while (pos > 0 && suffix[pos - 1] >= '0' && suffix[pos - 1] <= '9') {
+        --pos;
+    }
+    size_t digits = digitsEnd - pos;
+    if (digits == 0 || digits > MAX_LITERAL_DIGITS || pos == 0 || suffix[pos - 1] != '{') {
+        return false;
+    }
+    size_t result = 0;
+    for (size_t k = pos; k < digitsEnd; ++k) {
+        result = result * 10 + static_cast<size_t>(suffix[k] - '0');
+    }
+    value = result;
+    return true;
+}
+
+bool LiteralTracker::restore(size_t remaining, const char* tailData, size_t length) {
+    if (length > TAIL_SIZE) {
+        return false;
+    }
+    literalRemaining = remaining;
+    memcpy(tail, tailData, length);
+    tailLength = length;
+    return true;
+}
+
+void LiteralTracker::keepTail(const char* begin, const char* end) {
+    size_t length = static_cast<size_t>(end - begin);
+    if (length >= TAIL_SIZE) {
+        memcpy(tail, end - TAIL_SIZE, TAIL_SIZE);
+        tailLength = TAIL_SIZE;
+        return;
+    }
+    size_t keep = std::min(tailLength, TAIL_SIZE - length);
+    memmove(tail, tail + tailLength - keep, keep);
+    memcpy(tail + keep, begin, length);
+    tailLength = keep + length;
+}
+
+} // namespace flow_table
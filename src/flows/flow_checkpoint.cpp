@@ -0,0 +1,334 @@
+/**
+ * @file flow_checkpoint.cpp
+ * @brief 流表检查点的保存和恢复
+ *
+ * 文件格式（主机字节序，只在同一台机器上重启时使用）：
+ *   文件头：魔数"FLOWCKP1"(8字节)，版本(u32)，保留(u32)，流数量(u64)
+ *   每个流：C2S四元组的源端和目标端（IP版本u8，IPv4为u32、IPv6为16字节，端口u16），
+ *           空闲时间(i64，毫秒)，两个方向的容量上限(u64)，
+ *           两个方向缓冲区中尚未解析的字节(u32长度+数据)，
+ *           两个方向的解析状态(u32数量，每项u32长度+数据)，
+ *           两个方向的literal跟踪状态(当前literal剩余字节u64，未结束行的最后几个字节u32长度+数据)
+ * 流按最久未活动到最近活动的顺序保存，恢复后时间链表的顺序不变。
+ */
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../include/flows/flow_manager.h"
+
+namespace flow_table {
+
+static const char CHECKPOINT_MAGIC[8] = {'F', 'L', 'O', 'W', 'C', 'K', 'P', '1'};
+static const uint32_t CHECKPOINT_VERSION = 2;   // 版本2增加了literal跟踪状态
+
+// 顺序写入定长字段和变长数据
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::ofstream& out) : out(out) {}
+
+    template <typename T>
+    void put(T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putBytes(const char* data, size_t length) {
+        put(static_cast<uint32_t>(length));
+        out.write(data, static_cast<std::streamsize>(length));
+    }
+
+    void putEndpoint(unsigned char ipvN, unsigned int ipv4, const unsigned char* ipv6, int port) {
+        put(static_cast<uint8_t>(ipvN));
+        if (ipvN == 6) {
+            out.write(reinterpret_cast<const char*>(ipv6), 16);
+        } else {
+            put(static_cast<uint32_t>(ipv4));
+        }
+        put(static_cast<uint16_t>(port));
+    }
+
+    void putBuffer(const CircularString& buffer) {
+        if (buffer.size() == 0) {
+            put(static_cast<uint32_t>(0));
+            return;
+        }
+        // 按段直接写出缓冲区内容，不经过临时字符串
+        put(static_cast<uint32_t>(buffer.size()));
+        CircularString::Segment parts[2];
+        size_t partCount = buffer.segments(0, buffer.size() - 1, parts);
+        for (size_t i = 0; i < partCount; i++) {
+            out.write(parts[i].data, static_cast<std::streamsize>(parts[i].length));
+        }
+    }
+
+    void putStrings(const std::vector<std::string>& values) {
+        put(static_cast<uint32_t>(values.size()));
+        for (const std::string& value : values) {
+            putBytes(value.data(), value.size());
+        }
+    }
+
+private:
+    std::ofstream& out;
+};
+
+// 从映射的内存中顺序读取，每次读取前检查边界
+class CheckpointReader {
+public:
+    CheckpointReader(const char* data, size_t length) : cursor(data), end(data + length) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end - cursor) < sizeof(value)) {
+            return false;
+        }
+        memcpy(&value, cursor, sizeof(value));
+        cursor += sizeof(value);
+        return true;
+    }
+
+    // 读取变长数据，返回指向映射内存的指针，不复制
+    bool getBytes(const char*& data, uint32_t& length) {
+        if (!get(length) || static_cast<size_t>(end - cursor) < length) {
+            return false;
+        }
+        data = cursor;
+        cursor += length;
+        return true;
+    }
+
+    bool getEndpoint(unsigned char& ipvN, unsigned int& ipv4, unsigned char* ipv6, int& port) {
+        uint8_t version;
+        uint16_t portValue;
+        if (!get(version) || (version != 4 && version != 6)) {
+            return false;
+        }
+        ipvN = version;
+        if (version == 6) {
+            if (end - cursor < 16) {
+                return false;
+            }
+            memcpy(ipv6, cursor, 16);
+            cursor += 16;
+        } else {
+            uint32_t address;
+            if (!get(address)) {
+                return false;
+            }
+            ipv4 = address;
+        }
+        if (!get(portValue)) {
+            return false;
+        }
+        port = portValue;
+        return true;
+    }
+
+    bool getStrings(std::vector<std::string>* values) {
+        uint32_t count;
+        if (!get(count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            const char* data;
+            uint32_t length;
+            if (!getBytes(data, length)) {
+                return false;
+            }
+            if (values) {
+                values->emplace_back(data, length);
+            }
+        }
+        return true;
+    }
+
+    bool atEnd() const { return cursor == end; }
+
+private:
+    const char* cursor;
+    const char* end;
+};
+
+// 一个流的检查点记录（数据指向映射的内存）
+struct CheckpointRecord {
+    FourTuple c2sTuple;
+    int64_t idleMs = 0;
+    uint64_t c2sCapacity = 0;
+    uint64_t s2cCapacity = 0;
+    const char* c2sData = nullptr;
+    uint32_t c2sLength = 0;
+    const char* s2cData = nullptr;
+    uint32_t s2cLength = 0;
+    uint64_t c2sLiteralRemaining = 0;
+    const char* c2sLiteralTail = nullptr;
+    uint32_t c2sLiteralTailLength = 0;
+    uint64_t s2cLiteralRemaining = 0;
+    const char* s2cLiteralTail = nullptr;
+    uint32_t s2cLiteralTailLength = 0;
+};
+
+// 读取一个流的记录；states为空时只校验并跳过解析状态
+static bool readRecord(CheckpointReader& reader, CheckpointRecord& record,
+                       std::vector<std::string>* c2sState, std::vector<std::string>* s2cState) {
+    FourTuple& tuple = record.c2sTuple;
+    memset(&tuple, 0, sizeof(tuple));
+    if (!reader.getEndpoint(tuple.srcIPvN, tuple.srcIPv4, tuple.srcIPv6, tuple.sourcePort) ||
+        !reader.getEndpoint(tuple.dstIPvN, tuple.dstIPv4, tuple.dstIPv6, tuple.destPort)) {
+        return false;
+    }
+    if (!reader.get(record.idleMs) || !reader.get(record.c2sCapacity) || !reader.get(record.s2cCapacity) ||
+        record.c2sCapacity == 0 || record.s2cCapacity == 0) {
+        return false;
+    }
+    if (!reader.getBytes(record.c2sData, record.c2sLength) || !reader.getBytes(record.s2cData, record.s2cLength) ||
+        record.c2sLength > record.c2sCapacity || record.s2cLength > record.s2cCapacity) {
+        return false;
+    }
+    if (!reader.getStrings(c2sState) || !reader.getStrings(s2cState)) {
+        return false;
+    }
+    // 恢复在literal中间的流时继续跳过literal内容，不把正文当作命令或响应行扫描
+    return reader.get(record.c2sLiteralRemaining) &&
+           reader.getBytes(record.c2sLiteralTail, record.c2sLiteralTailLength) &&
+           record.c2sLiteralTailLength <= LiteralTracker::TAIL_SIZE &&
+           reader.get(record.s2cLiteralRemaining) &&
+           reader.getBytes(record.s2cLiteralTail, record.s2cLiteralTailLength) &&
+           record.s2cLiteralTailLength <= LiteralTracker::TAIL_SIZE;
+}
+
+bool HashFlowTable::saveCheckpoint(const std::string& path) const {
+    // 先写临时文件再改名，保存中途失败不会留下不完整的检查点
+    std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "警告: 无法创建检查点文件 " << tempPath << std::endl;
+        return false;
+    }
+
+    CheckpointWriter writer(out);
+    out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    writer.put(CHECKPOINT_VERSION);
+    writer.put(static_cast<uint32_t>(0));
+    writer.put(static_cast<uint64_t>(flowIndex.size()));
+
+    // 保存空闲时间而不是绝对时间，恢复时按新流表的时钟换算
+    int64_t nowMs = timeSource.now();
+    for (const Flow* flow = lruHead; flow; flow = flow->lruNext) {
+        const FourTuple& tuple = flow->c2sTuple;
+        writer.putEndpoint(tuple.srcIPvN, tuple.srcIPv4, tuple.srcIPv6, tuple.sourcePort);
+        writer.putEndpoint(tuple.dstIPvN, tuple.dstIPv4, tuple.dstIPv6, tuple.destPort);
+        writer.put(static_cast<int64_t>(nowMs - flow->lastActivityTime));
+        writer.put(static_cast<uint64_t>(flow->c2sBuffer.cap()));
+        writer.put(static_cast<uint64_t>(flow->s2cBuffer.cap()));
+        writer.putBuffer(flow->c2sBuffer);
+        writer.putBuffer(flow->s2cBuffer);
+        writer.putStrings(flow->c2sState);
+        writer.putStrings(flow->s2cState);
+        writer.put(static_cast<uint64_t>(flow->c2sLiterals.remaining()));
+        writer.putBytes(flow->c2sLiterals.pendingTail(), flow->c2sLiterals.pendingTailLength());
+        writer.put(static_cast<uint64_t>(flow->s2cLiterals.remaining()));
+        writer.putBytes(flow->s2cLiterals.pendingTail(), flow->s2cLiterals.pendingTailLength());
+    }
+
+    out.close();
+    if (!out) {
+        std::cerr << "警告: 写入检查点文件失败 " << tempPath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "警告: 无法保存检查点文件 " << path << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool HashFlowTable::restoreCheckpoint(const std::string& path, size_t& restoredFlows) {
+    restoredFlows = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CHECKPOINT_MAGIC) + 16)) {
+        close(fd);
+        std::cerr << "警告: 检查点文件不完整 " << path << std::endl;
+        return false;
+    }
+    // 映射整个文件，缓冲区数据直接从映射的内存复制到流的缓冲区
+    size_t length = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "警告: 无法映射检查点文件 " << path << std::endl;
+        return false;
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    const char* data = static_cast<const char*>(mapped);
+
+    // 校验文件头
+    CheckpointReader header(data + sizeof(CHECKPOINT_MAGIC), length - sizeof(CHECKPOINT_MAGIC));
+    uint32_t version = 0;
+    uint32_t reserved = 0;
+    uint64_t flowCount = 0;
+    bool valid = memcmp(data, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0 &&
+                 header.get(version) && header.get(reserved) && header.get(flowCount) &&
+                 version == CHECKPOINT_VERSION;
+
+    // 先完整校验一遍，文件损坏时不恢复任何流
+    CheckpointRecord record;
+    if (valid) {
+        CheckpointReader reader = header;
+        for (uint64_t i = 0; i < flowCount && valid; i++) {
+            valid = readRecord(reader, record, nullptr, nullptr);
+        }
+        valid = valid && reader.atEnd();
+    }
+    if (!valid) {
+        munmap(mapped, length);
+        std::cerr << "警告: 检查点文件格式无效 " << path << std::endl;
+        return false;
+    }
+
+    int64_t nowMs = timeSource.now();
+    CheckpointReader reader = header;
+    for (uint64_t i = 0; i < flowCount; i++) {
+        std::vector<std::string> c2sState;
+        std::vector<std::string> s2cState;
+        readRecord(reader, record, &c2sState, &s2cState);
+
+        // 已存在的连接（例如恢复前已有数据包到达）保留当前状态
+        FlowKey key(record.c2sTuple);
+        uint64_t hash = hashFlowKey(key);
+        if (flowIndex.find(key, hash)) {
+            continue;
+        }
+        BufferProfile profile = sizingPolicy->profileFor(record.c2sTuple.destPort);
+        profile.c2s.maximum = static_cast<size_t>(record.c2sCapacity);
+        profile.s2c.maximum = static_cast<size_t>(record.s2cCapacity);
+        Flow* flow = createFlow(record.c2sTuple, key, hash, profile, nowMs - record.idleMs);
+
+        flow->c2sBuffer.push_back(record.c2sData, record.c2sLength);
+        flow->s2cBuffer.push_back(record.s2cData, record.s2cLength);
+        flow->c2sState.swap(c2sState);
+        flow->s2cState.swap(s2cState);
+        flow->c2sLiterals.restore(static_cast<size_t>(record.c2sLiteralRemaining), record.c2sLiteralTail,
+                                  record.c2sLiteralTailLength);
+        flow->s2cLiterals.restore(static_cast<size_t>(record.s2cLiteralRemaining), record.s2cLiteralTail,
+                                  record.s2cLiteralTailLength);
+        updateBufferAccounting(flow);
+        enforceLimits(flow);
+        ++restoredFlows;
+    }
+
+    munmap(mapped, length);
+    return true;
+}
+
+} // namespace flow_table
@@ -0,0 +1,122 @@
+#include <utility>
+#include "../../include/flows/flow_index.h"
+
+namespace flow_table {
+
+// 最大负载因子为7/8
+static const size_t MAX_LOAD_NUMERATOR = 7;
+static const size_t MAX_LOAD_DENOMINATOR = 8;
+
+FlowIndex::FlowIndex(size_t initialCapacity) : mask(0), count(0) {
+    // 槽位数向上取整为2的幂，至少为8
+    size_t capacity = 8;
+    while (capacity < initialCapacity) {
+        capacity <<= 1;
+    }
+    slots.resize(capacity);
+    for (Slot& slot : slots) {
+        slot.dist = 0;
+    }
+    mask = capacity - 1;
+}
+
+Flow* FlowIndex::find(const FlowKey& key, uint64_t hash) const {
+    size_t pos = hash & mask;
+    uint32_t dist = 1;
+    while (true) {
+        const Slot& slot = slots[pos];
+        // 遇到空槽或比当前探测距离更"富"的槽，说明键不存在
+        if (slot.dist < dist) {
+            return nullptr;
+        }
+        if (slot.hash == hash && slot.key == key) {
+            return slot.flow;
+        }
+        pos = (pos + 1) & mask;
+        ++dist;
+    }
+}
+
+void FlowIndex::insert(const FlowKey& key, uint64_t hash, Flow* flow) {
+    if ((count + 1) * MAX_LOAD_DENOMINATOR > slots.size() * MAX_LOAD_NUMERATOR) {
+        grow();
+    }
+    Slot entry;
+    entry.hash = hash;
+    entry.flow = flow;
+    entry.key = key;
+    entry.dist = 0;
+    insertNoGrow(entry);
+}
+
+void FlowIndex::insertNoGrow(Slot entry) {
+    size_t pos = entry.hash & mask;
+    entry.dist = 1;
+    while (true) {
+        Slot& slot = slots[pos];
+        if (slot.dist == 0) {
+            slot = entry;
+            ++count;
+            return;
+        }
+        // Robin Hood：探测距离更短的元素让出位置
+        if (slot.dist < entry.dist) {
+            std::swap(slot, entry);
+        }
+        pos = (pos + 1) & mask;
+        ++entry.dist;
+    }
+}
+
+bool FlowIndex::erase(const FlowKey& key, uint64_t hash) {
+    size_t pos = hash & mask;
+    uint32_t dist = 1;
+    while (true) {
+        const Slot& slot = slots[pos];
+        if (slot.dist < dist) {
+            return false;
+        }
+        if (slot.hash == hash && slot.key == key) {
+            break;
+        }
+        pos = (pos + 1) & mask;
+        ++dist;
+    }
+
+    // 后移删除：把后续不在理想位置上的元素依次前移一格
+    size_t next = (pos + 1) & mask;
+    while (slots[next].dist > 1) {
+        slots[pos] = slots[next];
+        --slots[pos].dist;
+        pos = next;
+        next = (next + 1) & mask;
+    }
+    slots[pos].dist = 0;
+    --count;
+    return true;
+}
+
+void FlowIndex::clear() {
+    for (Slot& slot : slots) {
+        slot.dist = 0;
+    }
+    count = 0;
+}
+
+void FlowIndex::grow() {
+    std::vector<Slot> oldSlots;
+    oldSlots.swap(slots);
+    slots.resize(oldSlots.size() * 2);
+    for (Slot& slot : slots) {
+        slot.dist = 0;
+    }
+    mask = slots.size() - 1;
+    count = 0;
+    for (const Slot& slot : oldSlots) {
+        if (slot.dist != 0) {
+            insertNoGrow(slot);
+        }
+    }
+}
+
+} // namespace flow_table
@@ -12,6 +12,7 @@
 #include <iomanip>
 #include <cstring>
 #include <utility>
+#include <new>
 #include <sstream>
 #include <unistd.h>
 #include <limits.h>
@@ -54,6 +55,23 @@ size_t getBufferSizeFromConfig(const std::string& key, size_t defaultSize) {
     return config.getInt64(key, defaultSize);
 }
 
+//-------------------- InputPacket 实现 --------------------
+
+bool InputPacket::toView(PacketView& view) const {
+    if (type == "C2S") {
+        view.direction = PacketDirection::C2S;
+    } else if (type == "S2C") {
+        view.direction = PacketDirection::S2C;
+    } else {
+        return false;
+    }
+    view.data = payload.data();
+    view.length = payload.size();
+    view.fourTuple = fourTuple;
+    view.timestamp = timestamp;
+    return true;
+}
+
 //-------------------- Flow 类实现 --------------------
 
 Flow::Flow(const FourTuple& c2sTuple, const FourTuple& s2cTuple)
@@ -61,8 +79,9 @@ Flow::Flow(const FourTuple& c2sTuple, const FourTuple& s2cTuple)
       s2cTuple(s2cTuple),
       c2sBuffer(getBufferSizeFromConfig("Buffer.c2s_buffer_size", 10 * 1024 * 1024)), // 从配置文件读取C2S缓冲区大小
       s2cBuffer(getBufferSizeFromConfig("Buffer.s2c_buffer_size", 10 * 1024 * 1024)), // 从配置文件读取S2C缓冲区大小
-      lastActivityTime(std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::system_clock::now().time_since_epoch()).count()) { // 初始化最后活动时间为当前时间（毫秒）
+      lastActivityTime(TimeSource::monotonicMs()) { // 初始化最后活动时间为当前时间（毫秒）
+    expiryTimer.owner = this;
+    
     // 初始化流对象
     // TODO: 实现初始化逻辑
 }
@@ -71,46 +90,75 @@ Flow::Flow(const FourTuple& c2sTuple)
     : c2sTuple(c2sTuple),
       c2sBuffer(getBufferSizeFromConfig("Buffer.c2s_buffer_size", 10 * 1024 * 1024)), // 从配置文件读取C2S缓冲区大小
       s2cBuffer(getBufferSizeFromConfig("Buffer.s2c_buffer_size", 10 * 1024 * 1024)), // 从配置文件读取S2C缓冲区大小
-      lastActivityTime(std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::system_clock::now().time_since_epoch()).count()) { // 初始化最后活动时间为当前时间（毫秒）
+      lastActivityTime(TimeSource::monotonicMs()) { // 初始化最后活动时间为当前时间（毫秒）
     
     // 自动生成S2C方向的四元组（反转C2S四元组）
-    s2cTuple.srcIPvN = c2sTuple.dstIPvN;
-    s2cTuple.dstIPvN = c2sTuple.srcIPvN;
-    
-    // 复制IPv4或IPv6地址
-    if (c2sTuple.srcIPvN == 4) {
-        s2cTuple.srcIPv4 = c2sTuple.dstIPv4;
-        s2cTuple.dstIPv4 = c2sTuple.srcIPv4;
-    } else if (c2sTuple.srcIPvN == 6) {
-        memcpy(s2cTuple.srcIPv6, c2sTuple.dstIPv6, 16);
-        memcpy(s2cTuple.dstIPv6, c2sTuple.srcIPv6, 16);
-    }
-    
-    // 交换端口
-    s2cTuple.sourcePort = c2sTuple.destPort;
-    s2cTuple.destPort = c2sTuple.sourcePort;
+    initS2CTuple();
+    expiryTimer.owner = this;
     
     // 初始化流对象
     // TODO: 实现初始化逻辑
 }
 
+Flow::Flow(const FourTuple& c2sTuple, size_t c2sBufferSize, size_t s2cBufferSize, int64_t nowMs)
+    : c2sTuple(c2sTuple),
+      c2sBuffer(c2sBufferSize),
+      s2cBuffer(s2cBufferSize),
+      lastActivityTime(nowMs) { // 最后活动时间取流表时钟的当前时间，不读取系统时钟
+    
+    // 自动生成S2C方向的四元组（反转C2S四元组）
+    initS2CTuple();
+    expiryTimer.owner = this;
+}
+
+Flow::Flow(const FourTuple& c2sTuple, const BufferProfile& profile, int64_t nowMs)
+    : c2sTuple(c2sTuple),
+      c2sBuffer(profile.c2s.maximum, profile.c2s.initial, profile.mirrored),
+      s2cBuffer(profile.s2c.maximum, profile.s2c.initial, profile.mirrored),
+      lastActivityTime(nowMs) { // 最后活动时间取流表时钟的当前时间，不读取系统时钟
+    
+    // 自动生成S2C方向的四元组（反转C2S四元组）
+    initS2CTuple();
+    expiryTimer.owner = this;
+}
+
+void Flow::growBufferCapacity(PacketDirection direction, size_t capacity) {
+    if (direction == PacketDirection::C2S) {
+        c2sBuffer.grow_capacity(capacity);
+    } else {
+        s2cBuffer.grow_capacity(capacity);
+    }
+}
+
+void Flow::initS2CTuple() {
+    // 交换源端和目标端（只在建流时执行一次）
+    s2cTuple = c2sTuple.reversed();
+}
+
 void Flow::addC2SData(const std::string& data) {
+    addC2SData(data.data(), data.size());
+}
+
+void Flow::addC2SData(const char* data, size_t length) {
     // 向C2S缓冲区添加数据
-    if (!data.empty()) {
-        c2sBuffer.push_back(data);
-        std::cout << "添加C2S数据: " << data.size() << " 字节" << std::endl;
+    if (length > 0) {
+        c2sBuffer.push_back(data, length);
+        std::cout << "添加C2S数据: " << length << " 字节" << std::endl;
     }
-    updateLastActivityTime();
+    // 最后活动时间由流表在getOrCreateFlow()中按流表时钟更新，这里不再读取系统时钟
 }
 
 void Flow::addS2CData(const std::string& data) {
+    addS2CData(data.data(), data.size());
+}
+
+void Flow::addS2CData(const char* data, size_t length) {
     // 向S2C缓冲区添加数据
-    if (!data.empty()) {
-        s2cBuffer.push_back(data);
-        std::cout << "添加S2C数据: " << data.size() << " 字节" << std::endl;
+    if (length > 0) {
+        s2cBuffer.push_back(data, length);
+        std::cout << "添加S2C数据: " << length << " 字节" << std::endl;
     }
-    updateLastActivityTime();
+    // 最后活动时间由流表在getOrCreateFlow()中按流表时钟更新，这里不再读取系统时钟
 }
 
 bool Flow::parseC2SData() {
@@ -134,23 +182,12 @@ bool Flow::parseC2SData() {
             std::cout << "缓冲区为空" << std::endl;
             return false;
         }
-        // 找回车换行
-        end_line_index = c2sBuffer.find(0, buffer_size, '\r');
-        if (end_line_index == (size_t)(-1)) {
+        // 找回车换行，数据不完整（没有换行符或结尾是\r）时等待更多数据
+        end_line_index = c2sBuffer.find_crlf(0);
+        if (end_line_index == CircularString::npos) {
             std::cout << "缓冲区内未找到换行符" << std::endl;
             return false;
         }
-        try {
-            c2sBuffer.at(end_line_index + 1);
-        }
-        catch (std::out_of_range e) {
-            std::cout << "缓冲区的结尾是\\r" << std::endl;
-            return false;
-        }
-        if (c2sBuffer.at(end_line_index + 1) != '\n') {
-            end_line_index--;
-            throw std::runtime_error("回车换行不匹配");
-        }
 
         // 解析标签的第一个字节
         if (curren_char >= 33 && curren_char <= 126 && curren_char != '+' && curren_char != '*') {
@@ -232,6 +269,10 @@ bool Flow::parseC2SData() {
                 curren_char = c2sBuffer.at(index++);
             }
         }
+        // 参数在行中单独的\r处结束（不是行尾的回车换行）
+        if (index - 1 != end_line_index) {
+            throw std::runtime_error("回车换行不匹配");
+        }
         curren_char = c2sBuffer.at(index++);
         //最后把解析的Message放入c2sMessages末尾
         c2sMessages.push_back(current_message);
@@ -250,6 +291,7 @@ bool Flow::parseC2SData() {
         }
         std::cerr << std::endl << std::dec;
         c2sBuffer.erase_up_to(end_line_index + 1);
+        ++parseErrors;
         return false;
     }
     
@@ -286,141 +328,145 @@ bool Flow::parseS2CData() {
 */
 
 void Flow::outputMessages() const {
+    outputMessages(std::cout);
+}
+
+void Flow::outputMessages(std::ostream& out) const {
     // 输出流中的消息数据
     
     // 1. 输出C2S方向的消息
-    std::cout << "\n===== C2S 方向消息 (" << c2sMessages.size() << " 条) =====" << std::endl;
+    out << "\n===== C2S 方向消息 (" << c2sMessages.size() << " 条) =====" << std::endl;
     for (size_t i = 0; i < c2sMessages.size(); ++i) {
         const Message& msg = c2sMessages[i];
-        std::cout << "[" << i + 1 << "] 标签: " << msg.tag << ", 命令: " << msg.command;
+        out << "[" << i + 1 << "] 标签: " << msg.tag << ", 命令: " << msg.command;
         
         // 输出参数
         if (!msg.args.empty()) {
-            std::cout << ", 参数: ";
+            out << ", 参数: ";
             for (size_t j = 0; j < msg.args.size(); ++j) {
-                std::cout << msg.args[j];
+                out << msg.args[j];
                 if (j < msg.args.size() - 1) {
-                    std::cout << ", ";
+                    out << ", ";
                 }
             }
         }
         
         // 输出邮件信息（如果有）
         if (!msg.fetch.empty()) {
-            std::cout << ", 获取到 " << msg.fetch.size() << " 封邮件";
+            out << ", 获取到 " << msg.fetch.size() << " 封邮件";
         }
         
-        std::cout << std::endl;
+        out << std::endl;
     }
     
     // 2. 输出S2C方向的消息
-    std::cout << "\n===== S2C 方向消息 (" << s2cMessages.size() << " 条) =====" << std::endl;
+    out << "\n===== S2C 方向消息 (" << s2cMessages.size() << " 条) =====" << std::endl;
     for (size_t i = 0; i < s2cMessages.size(); ++i) {
         const Message& msg = s2cMessages[i];
-        std::cout << "\n[" << i + 1 << "] ";
+        out << "\n[" << i + 1 << "] ";
         
         // 输出标签（如果有）
         if (!msg.tag.empty()) {
-            std::cout << "标签: " << msg.tag << ", ";
+            out << "标签: " << msg.tag << ", ";
         }
         
         // 输出命令（如果有）
         if (!msg.command.empty()) {
-            std::cout << "命令: " << msg.command;
+            out << "命令: " << msg.command;
         }
         
         // 输出参数
         if (!msg.args.empty()) {
-            std::cout << ", 参数: ";
+            out << ", 参数: ";
             for (size_t j = 0; j < msg.args.size(); ++j) {
-                std::cout << msg.args[j];
+                out << msg.args[j];
                 if (j < msg.args.size() - 1) {
-                    std::cout << ", ";
+                    out << ", ";
                 }
             }
         }
         
-        std::cout << std::endl;
+        out << std::endl;
         
         // 输出邮件信息（如果有）
         if (!msg.fetch.empty()) {
-            std::cout << "  └─ 包含 " << msg.fetch.size() << " 封邮件" << std::endl;
+            out << "  └─ 包含 " << msg.fetch.size() << " 封邮件" << std::endl;
             
             // 详细输出每封邮件的信息
             for (size_t j = 0; j < msg.fetch.size(); ++j) {
                 const Email& email = msg.fetch[j];
-                std::cout << "     ┌─ 邮件 #" << j + 1 << std::endl;
+                out << "     ┌─ 邮件 #" << j + 1 << std::endl;
                 
                 // 输出基本信息
                 if (email.sequence_number > 0) {
-                    std::cout << "     │  序列号: " << email.sequence_number << std::endl;
+                    out << "     │  序列号: " << email.sequence_number << std::endl;
                 }
                 if (email.uid > 0) {
-                    std::cout << "     │  UID: " << email.uid << std::endl;
+                    out << "     │  UID: " << email.uid << std::endl;
                 }
                 if (email.rfc822_size > 0) {
-                    std::cout << "     │  大小: " << email.rfc822_size << " 字节" << std::endl;
+                    out << "     │  大小: " << email.rfc822_size << " 字节" << std::endl;
                 }
                 if (!email.flags.empty()) {
-                    std::cout << "     │  标志: " << email.flags << std::endl;
+                    out << "     │  标志: " << email.flags << std::endl;
                 }
                 if (!email.internaldate.empty()) {
-                    std::cout << "     │  内部日期: " << email.internaldate << std::endl;
+                    out << "     │  内部日期: " << email.internaldate << std::endl;
                 }
                 
                 // 输出头部信息
-                std::cout << "     │" << std::endl;
-                std::cout << "     ├─ 邮件头部" << std::endl;
+                out << "     │" << std::endl;
+                out << "     ├─ 邮件头部" << std::endl;
                 
                 if (!email.body.header.from.empty()) {
-                    std::cout << "     │  发件人: " << email.body.header.from << std::endl;
+                    out << "     │  发件人: " << email.body.header.from << std::endl;
                 }
                 
                 if (!email.body.header.to.empty()) {
-                    std::cout << "     │  收件人: ";
+                    out << "     │  收件人: ";
                     for (size_t k = 0; k < email.body.header.to.size(); ++k) {
-                        std::cout << email.body.header.to[k];
+                        out << email.body.header.to[k];
                         if (k < email.body.header.to.size() - 1) {
-                            std::cout << ", ";
+                            out << ", ";
                         }
                     }
-                    std::cout << std::endl;
+                    out << std::endl;
                 }
                 
                 if (!email.body.header.cc.empty()) {
-                    std::cout << "     │  抄送: ";
+                    out << "     │  抄送: ";
                     for (size_t k = 0; k < email.body.header.cc.size(); ++k) {
-                        std::cout << email.body.header.cc[k];
+                        out << email.body.header.cc[k];
                         if (k < email.body.header.cc.size() - 1) {
-                            std::cout << ", ";
+                            out << ", ";
                         }
                     }
-                    std::cout << std::endl;
+                    out << std::endl;
                 }
                 
                 if (!email.body.header.subject.empty()) {
-                    std::cout << "     │  主题: ";
+                    out << "     │  主题: ";
                     for (size_t k = 0; k < email.body.header.subject.size(); ++k) {
-                        std::cout << email.body.header.subject[k];
+                        out << email.body.header.subject[k];
                         if (k < email.body.header.subject.size() - 1) {
-                            std::cout << " ";
+                            out << " ";
                         }
                     }
-                    std::cout << std::endl;
+                    out << std::endl;
                 }
                 
                 if (!email.body.header.date.empty()) {
-                    std::cout << "     │  日期: " << email.body.header.date << std::endl;
+                    out << "     │  日期: " << email.body.header.date << std::endl;
                 }
                 
                 if (!email.body.header.message_id.empty()) {
-                    std::cout << "     │  消息ID: " << email.body.header.message_id[0] << std::endl;
+                    out << "     │  消息ID: " << email.body.header.message_id[0] << std::endl;
                 }
                 
                 // 输出正文信息
                 if (!email.body.text.empty()) {
-                    std::cout << "     │" << std::endl;
-                    std::cout << "     ├─ 邮件正文" << std::endl;
+                    out << "     │" << std::endl;
+                    out << "     ├─ 邮件正文" << std::endl;
                     
                     // 将正文按行分割并添加缩进
                     std::istringstream iss(email.body.text);
@@ -430,29 +476,29 @@ void Flow::outputMessages() const {
                         if (line.empty()) continue;
                         
                         if (firstLine) {
-                            std::cout << "     │  " << line << std::endl;
+                            out << "     │  " << line << std::endl;
                             firstLine = false;
                         } else {
-                            std::cout << "     │  " << line << std::endl;
+                            out << "     │  " << line << std::endl;
                         }
                     }
                 }
                 
                 // 输出其他信息
                 if (!email.envelope.empty() || !email.bodystructure.empty()) {
-                    std::cout << "     │" << std::endl;
-                    std::cout << "     ├─ 其他信息" << std::endl;
+                    out << "     │" << std::endl;
+                    out << "     ├─ 其他信息" << std::endl;
                     
                     if (!email.envelope.empty()) {
-                        std::cout << "     │  信封: " << email.envelope << std::endl;
+                        out << "     │  信封: " << email.envelope << std::endl;
                     }
                     
                     if (!email.bodystructure.empty()) {
-                        std::cout << "     │  正文结构: " << email.bodystructure << std::endl;
+                        out << "     │  正文结构: " << email.bodystructure << std::endl;
                     }
                 }
                 
-                std::cout << "     └────────────────────────────────────" << std::endl;
+                out << "     └────────────────────────────────────" << std::endl;
             }
         }
     }
@@ -474,9 +520,8 @@ void Flow::cleanup() {
 }
 
 void Flow::updateLastActivityTime() {
-    // 更新最后活动时间为当前时间（毫秒）
-    lastActivityTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
+    // 更新最后活动时间为当前时间（毫秒），与流表时钟使用同一个单调时钟
+    lastActivityTime = TimeSource::monotonicMs();
 }
 
 int64_t Flow::getLastActivityTime() const {
@@ -485,12 +530,8 @@ int64_t Flow::getLastActivityTime() const {
 }
 
 bool Flow::isTimeout(int64_t timeoutMilliseconds) const {
-    // 获取当前时间（毫秒）
-    int64_t currentTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    
-    // 检查是否超时
-    return (currentTimeMs - lastActivityTime) > timeoutMilliseconds;
+    // 以单调时钟的当前时间检查是否超时
+    return isTimeout(timeoutMilliseconds, TimeSource::monotonicMs());
 }
 
 //-------------------- HashFlowTable 类实现 --------------------
@@ -535,35 +576,34 @@ bool convertStringToIP(const std::string& ipStr, FourTuple& tuple, bool isSource
     return false;
 }
 
-HashFlowTable::HashFlowTable() : flowTimeoutMilliseconds(120000) {
+HashFlowTable::HashFlowTable()
+    : flowPool(sizeof(Flow), alignof(Flow)),
+      flowTimeoutMilliseconds(120000),
+      timeWheel(1000, 3600000),
+      timeSource(TimeSourceMode::Monotonic) {
     // 初始化哈希流表
-    // 默认超时时间为120000毫秒（2分钟）
+    // 默认超时时间为120000毫秒（2分钟），缓冲区容量只在此处从配置文件读取一次，所有端口相同
+    // 时间轮默认刻度1秒，覆盖1小时；默认使用粗粒度单调时钟
+    setBufferSizes(getBufferSizeFromConfig("Buffer.c2s_buffer_size", 10 * 1024 * 1024),
+                   getBufferSizeFromConfig("Buffer.s2c_buffer_size", 10 * 1024 * 1024));
+    timeWheel.reset(timeSource.now());
 }
 
 HashFlowTable::~HashFlowTable() {
-    // 创建一个集合来跟踪已处理的流指针，避免重复删除
-    std::set<Flow*> processedFlows;
-    
     std::cout << "\n===== 析构函数开始执行 =====" << std::endl;
     
-    // 收集所有唯一的流对象
-    std::vector<Flow*> uniqueFlows;
-    for (auto& pair : flowMap) {
-        Flow* flow = pair.second;
-        if (flow && processedFlows.find(flow) == processedFlows.end()) {
-            processedFlows.insert(flow);
-            uniqueFlows.push_back(flow);
-        }
-    }
+    // 收集所有流对象（索引中每个流只出现一次）
+    std::vector<Flow*> uniqueFlows = getAllFlows();
     
     std::cout << "准备清理 " << uniqueFlows.size() << " 个流对象" << std::endl;
     
-    // 先清空映射，防止后续操作引用已删除的对象
-    flowMap.clear();
-    timeOrderedFlows.clear();
-    
-    // 清空时间桶
-    timeBuckets.clear();
+    // 先清空索引，防止后续操作引用已删除的对象
+    flowIndex.clear();
+    flowCache.clear();
+    lruHead = nullptr;
+    lruTail = nullptr;
+    bufferBytes = 0;
+    c2sBufferBytes = 0;
     
     // 删除所有流对象
     int flowCount = 0;
@@ -592,7 +632,7 @@ HashFlowTable::~HashFlowTable() {
         flow->cleanup();
         
         std::cout << "  - 删除流对象" << std::endl;
-        delete flow;
+        destroyFlow(flow);
     }
     
     std::cout << "所有流已清理完毕" << std::endl;
@@ -604,169 +644,284 @@ void HashFlowTable::setFlowTimeout(int64_t milliseconds) {
     flowTimeoutMilliseconds = milliseconds;
 }
 
-void HashFlowTable::addToTimeBucket(Flow* flow, int64_t timestampMs) {
-    if (!flow) return;
-    
-    // 计算桶的时间戳（向下取整到最近的BUCKET_INTERVAL）
-    int64_t bucketTimeMs = timestampMs - (timestampMs % BUCKET_INTERVAL);
-    
-    // 添加到对应的时间桶
-    timeBuckets[bucketTimeMs].insert(flow);
+bool HashFlowTable::setTimingWheel(int64_t granularityMs, int64_t horizonMs) {
+    if (flowIndex.size() != 0) {
+        std::cerr << "警告: 流表非空，无法修改时间轮设置" << std::endl;
+        return false;
+    }
+    bool configured = timeWheel.configure(granularityMs, horizonMs);
+    timeWheel.reset(timeSource.now());
+    return configured;
 }
 
-void HashFlowTable::removeFromTimeBucket(Flow* flow, int64_t timestampMs) {
-    if (!flow) return;
-    
-    // 计算桶的时间戳
-    int64_t bucketTimeMs = timestampMs - (timestampMs % BUCKET_INTERVAL);
-    
-    // 使用键直接查找和操作，避免迭代器问题
-    if (timeBuckets.count(bucketTimeMs) > 0) {
-        TimeBucket& bucket = timeBuckets[bucketTimeMs];
-        bucket.erase(flow);
-        
-        // 如果桶为空，移除桶
-        if (bucket.empty()) {
-            timeBuckets.erase(bucketTimeMs);
+void HashFlowTable::setMaxFlows(size_t maxFlows) {
+    this->maxFlows = maxFlows;
+    // 上限调小时立即淘汰多出的流
+    enforceLimits(nullptr);
+}
+
+void HashFlowTable::setMaxBufferBytes(size_t maxBufferBytes) {
+    this->maxBufferBytes = maxBufferBytes;
+    enforceLimits(nullptr);
+}
+
+void HashFlowTable::updateBufferAccounting(Flow* flow) {
+    size_t bytes = flow->getBufferBytes();
+    size_t c2sBytes = flow->c2sBuffer.memory_usage();
+    if (bytes == flow->accountedBytes && c2sBytes == flow->accountedC2SBytes) {
+        // 缓冲区没有增长（绝大多数数据包），不需要更新总量和计数器
+        return;
+    }
+    bufferBytes = bufferBytes - flow->accountedBytes + bytes;
+    c2sBufferBytes = c2sBufferBytes - flow->accountedC2SBytes + c2sBytes;
+    flow->accountedBytes = bytes;
+    flow->accountedC2SBytes = c2sBytes;
+    publishBufferBytes();
+}
+
+void HashFlowTable::publishBufferBytes() {
+    FlowTableCounters::set(counters.c2sBufferBytes, c2sBufferBytes);
+    FlowTableCounters::set(counters.s2cBufferBytes, bufferBytes - c2sBufferBytes);
+}
+
+void HashFlowTable::enforceLimits(const Flow* keep) {
+    // 链表头是最久未活动的流；正在处理的流总在链表尾，头等于它时说明只剩这一个流
+    while (lruHead && lruHead != keep) {
+        bool overFlows = maxFlows != 0 && flowIndex.size() > maxFlows;
+        bool overBytes = maxBufferBytes != 0 && bufferBytes > maxBufferBytes;
+        if (!overFlows && !overBytes) {
+            break;
         }
+        deleteFlow(lruHead);
+        FlowTableCounters::add(counters.evictions);
     }
 }
 
-void HashFlowTable::moveToNewTimeBucket(Flow* flow, int64_t oldTimestampMs, int64_t newTimestampMs) {
-    if (!flow) return;
-    
-    // 计算旧桶和新桶的时间戳
-    int64_t oldBucketTimeMs = oldTimestampMs - (oldTimestampMs % BUCKET_INTERVAL);
-    int64_t newBucketTimeMs = newTimestampMs - (newTimestampMs % BUCKET_INTERVAL);
-    
-    // 如果桶不同，则移动
-    if (oldBucketTimeMs != newBucketTimeMs) {
-        removeFromTimeBucket(flow, oldTimestampMs);
-        addToTimeBucket(flow, newTimestampMs);
+bool HashFlowTable::setTimeSource(TimeSourceMode mode) {
+    if (flowIndex.size() != 0) {
+        std::cerr << "警告: 流表非空，无法修改时间来源" << std::endl;
+        return false;
+    }
+    timeSource.setMode(mode);
+    timeWheel.reset(timeSource.now());
+    return true;
+}
+
+int64_t HashFlowTable::advanceClock(int64_t packetTimestampMs) {
+    int64_t nowMs = timeSource.observe(packetTimestampMs);
+    // 时间轮为空时直接对齐到新时间（数据包时间戳模式下首个时间戳与初始值相差很远），非空时不做任何事
+    timeWheel.reset(nowMs);
+    return nowMs;
+}
+
+void HashFlowTable::scheduleExpiry(Flow* flow) {
+    // 空闲时间严格大于超时时间才算超时，因此定时器设在超时点之后1毫秒
+    timeWheel.schedule(&flow->expiryTimer, flow->getLastActivityTime() + flowTimeoutMilliseconds + 1);
+}
+
+void HashFlowTable::setBufferSizes(size_t c2sBufferSize, size_t s2cBufferSize) {
+    // 只影响之后新建的流
+    BufferProfile profile;
+    profile.c2s.maximum = c2sBufferSize;
+    profile.s2c.maximum = s2cBufferSize;
+    sizingPolicy.reset(new PortBufferSizingPolicy(profile));
+}
+
+void HashFlowTable::setBufferSizingPolicy(std::unique_ptr<BufferSizingPolicy> policy) {
+    // 只影响之后新建的流，已有流的缓冲区不变
+    if (policy) {
+        sizingPolicy = std::move(policy);
+    }
+}
+
+void HashFlowTable::linkLruTail(Flow* flow) {
+    flow->lruPrev = lruTail;
+    flow->lruNext = nullptr;
+    if (lruTail) {
+        lruTail->lruNext = flow;
+    } else {
+        lruHead = flow;
     }
+    lruTail = flow;
+}
+
+void HashFlowTable::unlinkLru(Flow* flow) {
+    if (flow->lruPrev) {
+        flow->lruPrev->lruNext = flow->lruNext;
+    } else {
+        lruHead = flow->lruNext;
+    }
+    if (flow->lruNext) {
+        flow->lruNext->lruPrev = flow->lruPrev;
+    } else {
+        lruTail = flow->lruPrev;
+    }
+    flow->lruPrev = nullptr;
+    flow->lruNext = nullptr;
 }
 
 void HashFlowTable::addToTimeOrderedList(Flow* flow) {
     // 将流添加到时间排序的链表末尾（最新）
     if (flow) {
-        timeOrderedFlows.push_back(flow);
+        linkLruTail(flow);
         
-        // 添加到时间桶中
-        int64_t timestampMs = flow->getLastActivityTime();
-        addToTimeBucket(flow, timestampMs);
+        // 挂入超时定时器
+        scheduleExpiry(flow);
     }
 }
 
 void HashFlowTable::removeFromTimeOrderedList(Flow* flow) {
-    // 从时间排序链表中移除流
+    // 通过流内的前后指针直接摘链，O(1)
     if (flow) {
-        timeOrderedFlows.remove(flow);
+        unlinkLru(flow);
         
-        // 从时间桶中移除
-        int64_t timestampMs = flow->getLastActivityTime();
-        removeFromTimeBucket(flow, timestampMs);
+        // 取消超时定时器
+        timeWheel.cancel(&flow->expiryTimer);
     }
 }
 
 void HashFlowTable::updateFlowPosition(Flow* flow) {
     if (!flow) return;
     
-    // 保存旧的时间戳
-    int64_t oldTimestampMs = flow->getLastActivityTime();
-    
-    // 从链表中移除
-    removeFromTimeOrderedList(flow);
-    // 再添加到链表末尾（最新）
-    addToTimeOrderedList(flow);
+    // 移动到链表末尾（最新），已经在末尾时无需操作，整个过程不分配内存
+    if (flow != lruTail) {
+        unlinkLru(flow);
+        linkLruTail(flow);
+    }
     
-    // 更新时间桶（在addToTimeOrderedList中已经添加到新桶）
-    // 这里不需要额外操作，因为removeFromTimeOrderedList已经从旧桶移除
+    // 超时定时器不随每个数据包移动：定时器触发时再根据最后活动时间决定删除还是重新挂入
 }
 
 void HashFlowTable::checkAndCleanupTimeoutFlows() {
-    // 获取当前时间（毫秒）
-    int64_t currentTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    
-    // 创建一个临时向量存储要删除的流
-    std::vector<Flow*> flowsToDelete;
+    sweepTimeoutFlows(0);
+}
+
+size_t HashFlowTable::sweepTimeoutFlows(size_t budget) {
+    // 单调时钟模式下刷新一次时钟，数据包时间戳模式下沿用最近一个数据包的时间
+    int64_t nowMs = timeSource.refresh();
+    packetsSinceSweep = 0;
+    lastSweepMs = nowMs;
     
-    // 计算超时时间点
-    int64_t timeoutBeforeMs = currentTimeMs - flowTimeoutMilliseconds;
+    // 推进时间轮，只处理经过的槽位；到期的定时器只是移入到期链表，开销主要在删除流
+    timeWheel.advance(nowMs);
     
-    // 首先找出所有需要检查的时间桶键
-    std::vector<int64_t> bucketsToCheck;
-    for (const auto& pair : timeBuckets) {
-        if (pair.first <= timeoutBeforeMs) {
-            bucketsToCheck.push_back(pair.first);
+    // 逐个处理到期的定时器，不需要临时容器；超出预算的留给下一步
+    size_t handled = 0;
+    size_t deleted = 0;
+    while (budget == 0 || handled < budget) {
+        TimerNode* node = timeWheel.popExpired();
+        if (!node) {
+            break;
         }
-    } 
-    
-    // 现在处理这些桶
-    for (int64_t bucketTimeMs : bucketsToCheck) {
-        // 获取桶（如果还存在）
-        if (timeBuckets.count(bucketTimeMs) > 0) {
-            // 创建要检查的流的副本，避免在遍历过程中修改
-            std::vector<Flow*> flowsToCheck;
-            for (Flow* flow : timeBuckets[bucketTimeMs]) {
-                flowsToCheck.push_back(flow);
-            }
-            
-            // 检查每个流
-            for (Flow* flow : flowsToCheck) {
-                if (flow->isTimeout(flowTimeoutMilliseconds)) {
-                    // 将超时流添加到待删除列表
-                    flowsToDelete.push_back(flow);
-                    // 从桶中移除
-                    timeBuckets[bucketTimeMs].erase(flow);
-                }
-            }
-            
-            // 如果桶为空，移除桶
-            if (timeBuckets[bucketTimeMs].empty()) {
-                timeBuckets.erase(bucketTimeMs);
-            }
+        ++handled;
+        Flow* flow = static_cast<Flow*>(node->owner);
+        if (flow->isTimeout(flowTimeoutMilliseconds, nowMs)) {
+            deleteFlow(flow);
+            FlowTableCounters::add(counters.timeouts);
+            ++deleted;
+        } else {
+            // 定时器挂入后流又有活动，按新的最后活动时间重新挂入
+            scheduleExpiry(flow);
         }
     }
-    
-    // 删除超时的流
-    for (Flow* flow : flowsToDelete) {
-        // 从时间排序链表中移除
-        timeOrderedFlows.remove(flow);
-        // 删除流
-        deleteFlow(flow);
+    FlowTableCounters::set(counters.pendingExpiry, timeWheel.pendingExpired());
+    return deleted;
+}
+
+void HashFlowTable::setSweepPolicy(uint64_t everyPackets, int64_t everyMs, size_t budget) {
+    sweepEveryPackets = everyPackets;
+    sweepEveryMs = everyMs > 0 ? everyMs : 0;
+    sweepBudget = budget;
+    packetsSinceSweep = 0;
+    lastSweepMs = timeSource.now();
+}
+
+size_t HashFlowTable::maybeSweep() {
+    // 只比较计数和缓存的时间，不到间隔时不读取时钟也不碰时间轮
+    ++packetsSinceSweep;
+    bool due = (sweepEveryPackets != 0 && packetsSinceSweep >= sweepEveryPackets) ||
+               (sweepEveryMs != 0 && timeSource.now() - lastSweepMs >= sweepEveryMs);
+    if (!due) {
+        return 0;
     }
+    return sweepTimeoutFlows(sweepBudget);
 }
 
 Flow* HashFlowTable::getOrCreateFlow(const FourTuple& fourTuple) {
-    // 计算四元组的哈希值
-    int hash = hashFourTuple(fourTuple);
-    
-    // 查找是否已存在对应的流
-    auto range = flowMap.equal_range(hash);
-    for (auto it = range.first; it != range.second; ++it) {
-        Flow* flow = it->second;
-        if (flow && flow->getC2STuple() == fourTuple) {
-            // 找到匹配的流，更新其最后活动时间
-            flow->updateLastActivityTime();
-            // 更新流在时间链表中的位置
-            updateFlowPosition(flow);
-            return flow;
+    return getOrCreateFlow(fourTuple, true);
+}
+
+Flow* HashFlowTable::getOrCreateFlow(const FourTuple& fourTuple, bool fromClient) {
+    // 生成规范化的连接键并计算哈希值（两个方向的键和哈希值都相同）
+    FlowKey key(fourTuple);
+    return lookupOrCreate(fourTuple, key, hashFlowKey(key), fromClient);
+}
+
+Flow* HashFlowTable::findFlow(const FlowKey& key, uint64_t hash) {
+    // 先查最近使用的流，未命中再查索引；两者都按连接键匹配，任一方向的四元组都能命中
+    FlowTableCounters::add(counters.cacheLookups);
+    Flow* flow = flowCache.find(key, hash);
+    if (flow) {
+        FlowTableCounters::add(counters.cacheHits);
+    } else {
+        flow = flowIndex.find(key, hash);
+        if (flow) {
+            flowCache.insert(key, hash, flow);
         }
     }
+    return flow;
+}
+
+void HashFlowTable::touchFlow(Flow* flow) {
+    // 用流表时钟的缓存时间更新最后活动时间
+    flow->updateLastActivityTime(timeSource.now());
+    // 更新流在时间链表中的位置
+    updateFlowPosition(flow);
+}
+
+Flow* HashFlowTable::lookupOrCreate(const FourTuple& fourTuple, const FlowKey& key, uint64_t hash, bool fromClient) {
+    // 查找是否已存在对应的流
+    Flow* flow = findFlow(key, hash);
+    if (flow) {
+        touchFlow(flow);
+        return flow;
+    }
     
     // 如果未找到匹配的流，创建新流
     std::cout << "未找到匹配的流，创建新流" << std::endl;
     
-    // 创建新流 - fourTuple是C2S方向
-    Flow* newFlow = new Flow(fourTuple);
+    // 流的C2S方向由首个数据包的方向决定，只有服务器先发数据时才需要反转一次四元组
+    const FourTuple c2sTuple = fromClient ? fourTuple : fourTuple.reversed();
+    // 按服务器端口（C2S方向的目标端口）决定两个方向的缓冲区大小
+    return createFlow(c2sTuple, key, hash, sizingPolicy->profileFor(c2sTuple.destPort), timeSource.now());
+}
+
+Flow* HashFlowTable::createFlow(const FourTuple& c2sTuple, const FlowKey& key, uint64_t hash, const BufferProfile& profile,
+                               int64_t lastActivityMs) {
+    // 创建新流，内存来自对象池
+    void* memory = flowPool.allocate();
+    Flow* newFlow = nullptr;
+    try {
+        newFlow = new (memory) Flow(c2sTuple, profile, lastActivityMs);
+    } catch (...) {
+        flowPool.deallocate(memory);
+        throw;
+    }
     
-    // 存储流，直接使用原始哈希值
-    flowMap.insert(std::pair<int, Flow*>(hash, newFlow));
+    // 存储流，索引中保存完整的64位哈希值，流自身也记住哈希值以便O(1)删除
+    newFlow->flowHash = hash;
+    flowIndex.insert(key, hash, newFlow);
+    flowCache.insert(key, hash, newFlow);
+    FlowTableCounters::add(counters.flowsCreated);
+    FlowTableCounters::set(counters.activeFlows, flowIndex.size());
     
     // 将新流添加到时间排序的链表中
     addToTimeOrderedList(newFlow);
     
+    // 计入缓冲区占用，超出流数量或内存上限时淘汰最久未活动的流
+    updateBufferAccounting(newFlow);
+    enforceLimits(newFlow);
+    
     // 注释掉这行代码，避免递归调用和多线程冲突
     // checkAndCleanupTimeoutFlows();
     
@@ -776,128 +931,283 @@ Flow* HashFlowTable::getOrCreateFlow(const FourTuple& fourTuple) {
 void HashFlowTable::deleteFlow(Flow* flow) {
     if (!flow) return;
     
-    // 在unordered_multimap中查找并删除特定流对象
-    // 我们需要遍历所有元素，找到值等于flow的键值对
-    using FlowMapIterator = std::unordered_multimap<int, Flow*>::iterator;
-    std::vector<std::pair<FlowMapIterator, FlowMapIterator>> rangesToRemove;
-    
-    // 首先找出所有包含此流的键
-    std::vector<int> keysWithFlow;
-    for (const auto& pair : flowMap) {
-        if (pair.second == flow) {
-            keysWithFlow.push_back(pair.first);
-        }
-    }
-    
-    // 对于每个键，找到对应的流并删除
-    for (int key : keysWithFlow) {
-        auto range = flowMap.equal_range(key);
-        for (auto it = range.first; it != range.second; ++it) {
-            if (it->second == flow) {
-                // 找到了要删除的流，从flowMap中移除
-                flowMap.erase(it);
-                break; // 找到并删除后跳出内层循环
-            }
-        }
-    }
+    // 使用流记录的哈希值从流索引中删除，无需重新计算哈希或扫描
+    flowIndex.erase(FlowKey(flow->getC2STuple()), flow->flowHash);
+    flowCache.invalidate(flow->flowHash, flow);
+    ++flowRemovals;
+    FlowTableCounters::set(counters.activeFlows, flowIndex.size());
     
     // 确保从时间链表中移除
     removeFromTimeOrderedList(flow);
     
+    // 从缓冲区总量中扣除
+    bufferBytes -= flow->accountedBytes;
+    c2sBufferBytes -= flow->accountedC2SBytes;
+    flow->accountedBytes = 0;
+    flow->accountedC2SBytes = 0;
+    publishBufferBytes();
+    
     // 调用流的清理方法
     flow->cleanup();
     
-    // 删除流对象
-    delete flow;
+    // 删除流对象，内存归还对象池
+    destroyFlow(flow);
+}
+
+void HashFlowTable::destroyFlow(Flow* flow) {
+    flow->~Flow();
+    flowPool.deallocate(flow);
 }
 
 bool HashFlowTable::processPacket(const InputPacket& packet) {
-    // 获取或创建对应的流
-    // 注意：此时packet.fourTuple已经被规范化为C2S方向
-    Flow* flow = getOrCreateFlow(packet.fourTuple);
+    PacketView view;
+    if (!packet.toView(view)) {
+        std::cerr << "未知的数据包类型" << std::endl;
+        return false;
+    }
+    return processPacket(view);
+}
+
+bool HashFlowTable::processPacket(const PacketView& packet) {
+    // 每个数据包推进一次流表时钟：单调时钟模式下读取一次粗粒度单调时钟（vDSO调用，不进入内核），
+    // 数据包时间戳模式下使用数据包携带的时间；流的活动时间和之后的清理判断都使用这个时间
+    advanceClock(packet.timestamp);
+    
+    FlowKey key(packet.fourTuple);
+    return processHashedPacket(packet, key, hashFlowKey(key));
+}
+
+// 批量处理时取得数据包视图：InputPacket需要转换，PacketView直接使用
+static inline bool packetViewOf(const InputPacket& packet, PacketView& view) {
+    if (!packet.toView(view)) {
+        std::cerr << "未知的数据包类型" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static inline bool packetViewOf(const PacketView& packet, PacketView& view) {
+    view = packet;
+    return true;
+}
+
+size_t HashFlowTable::processBatch(const InputPacket* packets, size_t count) {
+    return processBatchImpl(packets, count);
+}
+
+size_t HashFlowTable::processBatch(const PacketView* packets, size_t count) {
+    return processBatchImpl(packets, count);
+}
+
+template <typename Packet>
+size_t HashFlowTable::processBatchImpl(const Packet* packets, size_t count) {
+    // 每轮最多预取的数据包数量：预取的缓存行在处理前不应被挤出缓存
+    static const size_t PREFETCH_WINDOW = 64;
+    FlowKey keys[PREFETCH_WINDOW];
+    uint64_t hashes[PREFETCH_WINDOW];
+    Flow* found[PREFETCH_WINDOW];
+    
+    // Monotonic模式下整批共用一次时钟读取
+    bool perPacketClock = timeSource.mode() == TimeSourceMode::Packet;
+    if (!perPacketClock) {
+        advanceClock();
+    }
+    
+    size_t processed = 0;
+    for (size_t base = 0; base < count; base += PREFETCH_WINDOW) {
+        size_t n = count - base < PREFETCH_WINDOW ? count - base : PREFETCH_WINDOW;
+        
+        // 1. 生成连接键、计算哈希值并预取索引槽位
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = FlowKey(packets[base + i].fourTuple);
+            hashes[i] = hashFlowKey(keys[i]);
+            flowIndex.prefetch(hashes[i]);
+        }
+        
+        // 2. 查找已存在的流（先查流缓存）并预取流对象头部（此时槽位已在缓存中或正在加载）
+        uint64_t removalsBefore = flowRemovals;
+        for (size_t i = 0; i < n; i++) {
+            found[i] = findFlow(keys[i], hashes[i]);
+#if defined(__GNUC__) || defined(__clang__)
+            if (found[i]) {
+                __builtin_prefetch(found[i]);
+            }
+#endif
+        }
+        
+        // 3. 依次追加数据和解析；前面的数据包删除或淘汰过流时第2步的指针可能失效，重新查找，
+        //    否则直接使用第2步的结果（第2步未找到的流可能已由前面的数据包创建，同样重新查找）
+        for (size_t i = 0; i < n; i++) {
+            PacketView view;
+            if (!packetViewOf(packets[base + i], view)) {
+                continue;
+            }
+            if (perPacketClock) {
+                advanceClock(view.timestamp);
+            }
+            Flow* flow = flowRemovals == removalsBefore ? found[i] : nullptr;
+            if (processHashedPacket(view, keys[i], hashes[i], flow)) {
+                ++processed;
+            }
+        }
+    }
+    return processed;
+}
+
+bool HashFlowTable::processHashedPacket(const PacketView& packet, const FlowKey& key, uint64_t hash, Flow* found) {
+    // 获取或创建对应的流，调用者已找到流时不再查找
+    // packet.fourTuple是数据包自身的方向（源端为发送方），两个方向的连接键和哈希值相同，无需改写
+    bool fromClient = packet.direction == PacketDirection::C2S;
+    Flow* flow = found;
+    if (flow) {
+        touchFlow(flow);
+    } else {
+        flow = lookupOrCreate(packet.fourTuple, key, hash, fromClient);
+    }
     if (!flow) {
         std::cerr << "创建流失败" << std::endl;
         return false;
     }
     
-    // 根据数据包类型添加数据并进行解析
+    // 根据数据包方向添加数据并进行解析，载荷从调用者的缓冲区直接写入流的缓冲区
     bool needDeleteFlow = false;
     
-    if (packet.type == "C2S") {
-        flow->addC2SData(packet.payload);
+    // 先处理literal声明，使缓冲区在literal数据到达前就能容纳它
+    observeLiterals(flow, packet);
+    
+    // 解析前后的消息数和错误数之差计入统计
+    size_t messagesBefore = flow->c2sMessages.size() + flow->s2cMessages.size();
+    uint64_t errorsBefore = flow->parseErrors;
+    
+    if (fromClient) {
+        flow->addC2SData(packet.data, packet.length);
+        FlowTableCounters::raise(counters.peakRingBytes, flow->c2sBuffer.size());
         // 如果parseC2SData返回true，表示检测到LOGOUT命令
         needDeleteFlow = flow->parseC2SData();
-    } else if (packet.type == "S2C") {
-        flow->addS2CData(packet.payload);
-        flow->parseS2CData();
     } else {
-        std::cerr << "未知的数据包类型" << std::endl;
-        return false;
+        flow->addS2CData(packet.data, packet.length);
+        FlowTableCounters::raise(counters.peakRingBytes, flow->s2cBuffer.size());
+        flow->parseS2CData();
     }
     
+    FlowTableCounters::add(counters.packets);
+    countParsed(flow, messagesBefore, errorsBefore);
+    
+    // 缓冲区占用可能随数据增长，超出内存上限时淘汰其他最久未活动的流
+    updateBufferAccounting(flow);
+    enforceLimits(flow);
+    
     // 如果检测到LOGOUT命令，直接删除流
     if (needDeleteFlow) {
         std::cout << "执行流删除（LOGOUT命令）" << std::endl;
         deleteFlow(flow);
+        FlowTableCounters::add(counters.logoutDeletions);
         return true;
     }
     
     return true;
 }
 
+void HashFlowTable::countParsed(const Flow* flow, size_t messagesBefore, uint64_t errorsBefore) {
+    size_t messagesAfter = flow->c2sMessages.size() + flow->s2cMessages.size();
+    if (messagesAfter != messagesBefore) {
+        FlowTableCounters::add(counters.messagesParsed, messagesAfter - messagesBefore);
+    }
+    if (flow->parseErrors != errorsBefore) {
+        FlowTableCounters::add(counters.parseErrors, flow->parseErrors - errorsBefore);
+    }
+}
+
+bool HashFlowTable::closeFlow(const FourTuple& fourTuple, std::ostream& out) {
+    // 只查找不创建，关闭通告可能来自任一方向
+    FlowKey key(fourTuple);
+    Flow* flow = flowIndex.find(key, hashFlowKey(key));
+    if (!flow) {
+        return false;
+    }
+    
+    // 每次parseC2SData()只解析一行，逐行解析直到缓冲区中没有完整的命令
+    size_t messagesBefore = flow->c2sMessages.size() + flow->s2cMessages.size();
+    uint64_t errorsBefore = flow->parseErrors;
+    while (flow->c2sBuffer.size() > 0) {
+        size_t remaining = flow->c2sBuffer.size();
+        flow->parseC2SData();
+        if (flow->c2sBuffer.size() >= remaining) {
+            break;
+        }
+    }
+    if (flow->s2cBuffer.size() > 0) {
+        flow->parseS2CData();
+    }
+    countParsed(flow, messagesBefore, errorsBefore);
+    
+    flow->outputMessages(out);
+    deleteFlow(flow);
+    FlowTableCounters::add(counters.closes);
+    return true;
+}
+
+void HashFlowTable::observeLiterals(Flow* flow, const PacketView& packet) {
+    // 跳过尚未结束的literal内容，只在literal之外的行尾识别声明，正文中形如声明的文本不影响扩容和学习
+    LiteralTracker& literals = packet.direction == PacketDirection::C2S ? flow->c2sLiterals : flow->s2cLiterals;
+    size_t literalSize = 0;
+    if (!literals.feed(packet.data, packet.length, literalSize)) {
+        return;
+    }
+    size_t ceiling = sizingPolicy->observeLiteral(flow->getC2STuple().destPort, packet.direction, literalSize);
+    if (ceiling == 0) {
+        return;
+    }
+    // 缓冲区需要同时容纳已缓存的数据、本数据包和literal，再留出响应行和结尾的余量
+    size_t wanted = flow->getBufferedBytes(packet.direction) + packet.length + literalSize + LITERAL_HEADROOM;
+    if (wanted > ceiling) {
+        wanted = ceiling;
+    }
+    if (wanted > flow->getBufferCapacity(packet.direction)) {
+        flow->growBufferCapacity(packet.direction, wanted);
+    }
+}
+
 size_t HashFlowTable::getTotalFlows() const {
     // 获取流总数
-    return flowMap.size();
+    return flowIndex.size();
 }
 
 void HashFlowTable::outputResults() const {
-    // 输出所有流的处理结果
-    static std::set<Flow*> processedFlows;
-    for (const auto& pair : flowMap) {
-        // 确保每个流只输出一次（因为同一个流可能有两个哈希键）
-        if (processedFlows.find(pair.second) == processedFlows.end()) {
-            pair.second->outputMessages();
-            processedFlows.insert(pair.second);
-        }
-    }
-    // 清空已处理流的集合，为下一次调用做准备
-    processedFlows.clear();
+    outputResults(std::cout);
+}
+
+void HashFlowTable::outputResults(std::ostream& out) const {
+    // 输出所有流的处理结果（索引中每个流只出现一次）
+    flowIndex.forEach([&out](Flow* flow) {
+        flow->outputMessages(out);
+    });
 }
 
 std::vector<Flow*> HashFlowTable::getAllFlows() {
     std::vector<Flow*> result;
-    std::set<Flow*> uniqueFlows;
+    result.reserve(flowIndex.size());
     
-    // 遍历所有流，确保每个流只添加一次
-    for (const auto& pair : flowMap) {
-        if (uniqueFlows.find(pair.second) == uniqueFlows.end()) {
-            result.push_back(pair.second);
-            uniqueFlows.insert(pair.second);
-        }
-    }
+    // 遍历所有流
+    flowIndex.forEach([&result](Flow* flow) {
+        result.push_back(flow);
+    });
     
     return result;
 }
 
-int HashFlowTable::hashFourTuple(const FourTuple& fourTuple) const {
-    std::size_t hash = 0;
-    
-    // 哈希IP地址
-    if (fourTuple.srcIPvN == 4) {
-        hash = std::hash<uint32_t>{}(fourTuple.srcIPv4);
-        hash ^= std::hash<uint32_t>{}(fourTuple.dstIPv4) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-    } else if (fourTuple.srcIPvN == 6) {
-        for (int i = 0; i < 16; i++) {
-            hash ^= std::hash<unsigned char>{}(fourTuple.srcIPv6[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-            hash ^= std::hash<unsigned char>{}(fourTuple.dstIPv6[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-        }
+uint64_t HashFlowTable::hashFourTuple(const FourTuple& fourTuple) {
+    // 对称哈希：同一连接两个方向的数据包落在同一个索引槽位和同一个工作线程，保留完整的64位哈希值供流索引使用
+    return hashTuple(fourTuple);
+}
+
+unsigned int HashFlowTable::ownerShard(const FourTuple& fourTuple, unsigned int shardCount) {
+    if (shardCount <= 1) {
+        return 0;
     }
-    
-    // 哈希端口
-    hash ^= std::hash<int>{}(fourTuple.sourcePort) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-    hash ^= std::hash<int>{}(fourTuple.destPort) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-    
-    return static_cast<int>(hash);
+    // 取哈希值的高32位按乘法映射到[0, shardCount)，避免取模，也不与索引使用的低位重叠
+    uint64_t high = hashFourTuple(fourTuple) >> 32;
+    return static_cast<unsigned int>((high * shardCount) >> 32);
 }
 
 } // namespace flow_table
@@ -0,0 +1,66 @@
+#include <new>
+#include "../../include/flows/flow_pool.h"
+
+namespace flow_table {
+
+FlowPool::FlowPool(size_t objectSize, size_t objectAlign, size_t objectsPerSlab)
+    : slotAlign(objectAlign < alignof(FreeSlot) ? alignof(FreeSlot) : objectAlign),
+      slotsPerSlab(objectsPerSlab == 0 ? 1 : objectsPerSlab),
+      freeList(nullptr),
+      inUse(0) {
+    // 槽位至少能放下空闲链表指针，并按对齐要求向上取整，保证块内每个槽位都满足对齐
+    size_t size = objectSize < sizeof(FreeSlot) ? sizeof(FreeSlot) : objectSize;
+    slotSize = (size + slotAlign - 1) / slotAlign * slotAlign;
+}
+
+FlowPool::~FlowPool() {
+    for (void* slab : slabs) {
+        ::operator delete(slab);
+    }
+}
+
+void FlowPool::addSlab() {
+    // 先为块指针预留位置，之后的push_back不会抛出异常，申请到的内存块不会因此泄漏
+    if (slabs.size() == slabs.capacity()) {
+        slabs.reserve(slabs.empty() ? 8 : slabs.size() * 2);
+    }
+    // operator new返回的内存满足基本对齐要求，流对象不需要超过基本对齐
+    char* slab = static_cast<char*>(::operator new(slotSize * slotsPerSlab));
+    slabs.push_back(slab);
+
+    // 倒序挂入，使分配顺序与块内地址顺序一致
+    for (size_t i = slotsPerSlab; i > 0; --i) {
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(slab + (i - 1) * slotSize);
+        slot->next = freeList;
+        freeList = slot;
+    }
+}
+
+void* FlowPool::allocate() {
+    if (!freeList) {
+        addSlab();
+    }
+    FreeSlot* slot = freeList;
+    freeList = slot->next;
+    ++inUse;
+    return slot;
+}
+
+void FlowPool::deallocate(void* ptr) {
+    if (!ptr) return;
+    // 后进先出，刚释放的槽位很可能还在缓存中，下一个新流优先复用它
+    FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+    slot->next = freeList;
+    freeList = slot;
+    --inUse;
+}
+
+FlowPoolStats FlowPool::stats() const {
+    FlowPoolStats result;
+    result.slabs = slabs.size();
+    result.capacity = slabs.size() * slotsPerSlab;
+    result.inUse = inUse;
+    return result;
+}
+
+} // namespace flow_table
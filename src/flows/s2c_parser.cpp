@@ -11,6 +11,19 @@
 
 namespace flow_table {
 
+// 把缓冲区中的literal整段追加到out（不逐字节经过at()），然后读取literal之后的一个字符。
+// 调用时currentChar是literal的第一个字节，index指向它之后的位置；
+// 返回后与逐字节读取完literal的状态相同：currentChar是literal之后的字符，index指向它之后的位置
+static void readLiteral(CircularString& buffer, std::string& out, size_t& index, size_t length,
+                        char& currentChar) {
+    if (length == 0) {
+        return;
+    }
+    buffer.append_to(out, index - 1, index + length - 2);
+    index += length - 1;
+    currentChar = buffer.at(index++);
+}
+
 // 实现Flow::parseS2CData方法
 bool Flow::parseS2CData() {
     // 这里将Resolve_imap_body函数的实现搬运过来，并做适当修改
@@ -286,10 +299,7 @@ bool Flow::parseS2CData() {
                             currentChar = s2cBuffer.at(index++);
                             // 先把邮件体中的内容存下来，之后再分析
                             temp = "";
-                            for (int i = 0;i < currentNumber;i++) {
-                                temp.push_back(currentChar);
-                                currentChar = s2cBuffer.at(index++);
-                            }
+                            readLiteral(s2cBuffer, temp, index, currentNumber, currentChar);
                             Resolve_imap_body(temp, currentEmail, true, true);
                             break;
                         case  Fetch_name::RFC822_HEADER:  // 等同于BODY.PEEK[HEADER]
@@ -323,10 +333,7 @@ bool Flow::parseS2CData() {
                             currentChar = s2cBuffer.at(index++);
                             // 先把邮件体中的内容存下来，之后再分析
                             temp = "";
-                            for (int i = 0;i < currentNumber;i++) {
-                                temp.push_back(currentChar);
-                                currentChar = s2cBuffer.at(index++);
-                            }
+                            readLiteral(s2cBuffer, temp, index, currentNumber, currentChar);
                             // 先处理头部信息
                             Resolve_imap_body(temp, currentEmail, true, false);
                             break;
@@ -372,10 +379,7 @@ bool Flow::parseS2CData() {
                             currentChar = s2cBuffer.at(index++);
                             currentEmail.body.text = "";
                             // 字符串里的内容都是正文
-                            for (int i = 0;i < currentNumber;i++) {
-                                currentEmail.body.text.push_back(currentChar);
-                                currentChar = s2cBuffer.at(index++);
-                            }
+                            readLiteral(s2cBuffer, currentEmail.body.text, index, currentNumber, currentChar);
                             break;
                         case  Fetch_name::UID:
                             if (!std::isdigit(currentChar)) {
@@ -453,10 +457,7 @@ bool Flow::parseS2CData() {
                             currentChar = s2cBuffer.at(index++);
                             // 先把邮件体中的内容存下来，之后再分析
                             temp = "";
-                            for (int i = 0;i < currentNumber;i++) {
-                                temp.push_back(currentChar);
-                                currentChar = s2cBuffer.at(index++);
-                            }
+                            readLiteral(s2cBuffer, temp, index, currentNumber, currentChar);
                             Resolve_imap_body(temp, currentEmail, has_header, has_text);
                             // 找到下一个非空白符（空格和水平制表符）
                             while (currentChar == ' ' || currentChar == 9) {
@@ -466,13 +467,10 @@ bool Flow::parseS2CData() {
                     }
                 }
                 // 找回车换行
-                endLineIndex = s2cBuffer.find(index, s2cBuffer.size(), '\r');
-                if (endLineIndex == (size_t)(-1)) {
+                endLineIndex = s2cBuffer.find_crlf(index);
+                if (endLineIndex == CircularString::npos) {
                     throw std::out_of_range("Fetch的右括号后没找到换行符");
                 }
-                if (s2cBuffer.at(endLineIndex + 1) != '\n') {
-                    throw std::runtime_error("回车换行不匹配");
-                }
                 
                 // 试着对邮件内容进行解码
                 if (currentEmail.body.text != "") {
@@ -566,13 +564,10 @@ bool Flow::parseS2CData() {
                     currentChar = s2cBuffer.at(index++);
                 }
                 // 找到行末尾的换行符
-                endLineIndex = s2cBuffer.find(index - 1, s2cBuffer.size(), '\r');
-                if (endLineIndex == (size_t)(-1)) {
+                endLineIndex = s2cBuffer.find_crlf(index - 1);
+                if (endLineIndex == CircularString::npos) {
                     throw std::out_of_range("缓冲区内未找到换行符");
                 }
-                if (s2cBuffer.at(endLineIndex + 1) != '\n') {
-                    throw std::runtime_error("回车换行不匹配");
-                }
                 // 把到换行符为止的字符一股脑存进args[0]中
                 temp = "";
                 while (index <= endLineIndex) {
@@ -618,6 +613,7 @@ bool Flow::parseS2CData() {
                     }
                     std::cerr << std::endl << std::dec;
                     s2cBuffer.erase_up_to(endLineIndex);     // 清理缓冲区
+                    ++parseErrors;
                 }
                 else {
                     // 情况三：响应语句不合法，能在buffer里找到换行符，且下一个字节是回车
@@ -632,6 +628,7 @@ bool Flow::parseS2CData() {
                     }
                     std::cerr << std::endl << std::dec;
                     s2cBuffer.erase_up_to(endLineIndex + 1);     // 清理缓冲区
+                    ++parseErrors;
                 }
             }
             catch (std::out_of_range e) {
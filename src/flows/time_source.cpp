@@ -0,0 +1,61 @@
+#include <time.h>
+#include <chrono>
+#include "../../include/flows/time_source.h"
+
+namespace flow_table {
+
+TimeSource::TimeSource(TimeSourceMode mode) : sourceMode(mode), nowMs(0) {
+    refresh();
+}
+
+void TimeSource::setMode(TimeSourceMode mode) {
+    sourceMode = mode;
+    nowMs = 0;
+    refresh();
+}
+
+int64_t TimeSource::refresh() {
+    if (sourceMode == TimeSourceMode::Monotonic) {
+        int64_t current = monotonicMs();
+        if (current > nowMs) {
+            nowMs = current;
+        }
+    }
+    return nowMs;
+}
+
+int64_t TimeSource::observe(int64_t timestampMs) {
+    if (sourceMode == TimeSourceMode::Monotonic) {
+        return refresh();
+    }
+    if (timestampMs > nowMs) {
+        nowMs = timestampMs;
+    }
+    return nowMs;
+}
+
+int64_t TimeSource::monotonicMs() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    // 粗粒度时钟通过vDSO读取内核维护的时间，不陷入内核，精度为一个时钟节拍（1~4毫秒）
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0) {
+        return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+#endif
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool TimeSource::parseMode(const std::string& name, TimeSourceMode& mode) {
+    if (name == "monotonic") {
+        mode = TimeSourceMode::Monotonic;
+        return true;
+    }
+    if (name == "packet") {
+        mode = TimeSourceMode::Packet;
+        return true;
+    }
+    return false;
+}
+
+} // namespace flow_table
@@ -0,0 +1,182 @@
+#include "../../include/flows/timing_wheel.h"
+
+namespace flow_table {
+
+// 最多使用的层数（64^10个刻度已远超任何实际需求）
+static const int MAX_LEVELS = 10;
+
+TimingWheel::TimingWheel(int64_t granularityMs, int64_t horizonMs)
+    : granularityMs(1),
+      levels(1),
+      maxTicks(0),
+      currentTick(0),
+      scheduled(0),
+      expiredCount(0) {
+    expired.prev = &expired;
+    expired.next = &expired;
+    configure(granularityMs, horizonMs);
+}
+
+bool TimingWheel::configure(int64_t granularityMs, int64_t horizonMs) {
+    if (scheduled != 0 || expiredCount != 0) {
+        return false;
+    }
+
+    // 当前时间保持不变，只换算到新的刻度
+    int64_t nowMs = currentTick * this->granularityMs;
+    this->granularityMs = granularityMs > 0 ? granularityMs : 1;
+    currentTick = nowMs / this->granularityMs;
+
+    // 根据覆盖范围计算需要的层数
+    int64_t horizonTicks = (horizonMs + this->granularityMs - 1) / this->granularityMs;
+    if (horizonTicks < 1) {
+        horizonTicks = 1;
+    }
+    levels = 1;
+    while (levels < MAX_LEVELS && ((int64_t)1 << (SLOT_BITS * levels)) - 1 < horizonTicks) {
+        ++levels;
+    }
+    maxTicks = ((int64_t)1 << (SLOT_BITS * levels)) - 1;
+
+    // 槽位哨兵一次性分配，之后不再扩容，保证哨兵地址不变
+    slots.assign(levels * SLOTS_PER_LEVEL, TimerNode());
+    for (TimerNode& head : slots) {
+        head.prev = &head;
+        head.next = &head;
+    }
+    return true;
+}
+
+void TimingWheel::linkBefore(TimerNode* head, TimerNode* node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+void TimingWheel::unlink(TimerNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void TimingWheel::reset(int64_t nowMs) {
+    if (scheduled == 0 && expiredCount == 0) {
+        currentTick = nowMs / granularityMs;
+    }
+}
+
+void TimingWheel::place(TimerNode* node) {
+    int64_t delta = node->expireTick - currentTick;
+    if (delta <= 0) {
+        // 已经到期，直接进入到期链表
+        linkBefore(&expired, node);
+        node->pending = true;
+        ++expiredCount;
+        return;
+    }
+
+    // 找到能容纳该刻度差的最低层
+    int level = 0;
+    while (level + 1 < levels && delta >= ((int64_t)1 << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    int64_t index = (node->expireTick >> (SLOT_BITS * level)) & SLOT_MASK;
+    linkBefore(&slots[level * SLOTS_PER_LEVEL + index], node);
+    ++scheduled;
+}
+
+void TimingWheel::schedule(TimerNode* node, int64_t expireMs) {
+    if (node->isLinked()) {
+        cancel(node);
+    }
+
+    // 向上取整到刻度，保证不会早于到期时间触发
+    node->expireTick = (expireMs + granularityMs - 1) / granularityMs;
+    if (node->expireTick - currentTick > maxTicks) {
+        // 超出覆盖范围，先放到最远的位置，触发后由调用者重新挂入
+        node->expireTick = currentTick + maxTicks;
+    }
+    place(node);
+}
+
+void TimingWheel::cancel(TimerNode* node) {
+    if (!node->isLinked()) {
+        return;
+    }
+    if (node->pending) {
+        node->pending = false;
+        --expiredCount;
+    } else {
+        --scheduled;
+    }
+    unlink(node);
+}
+
+void TimingWheel::cascade(int level, int64_t index) {
+    TimerNode* head = &slots[level * SLOTS_PER_LEVEL + index];
+    if (head->next == head) {
+        return;
+    }
+    // 先整体摘下，再逐个重新分配到更低的层
+    TimerNode* node = head->next;
+    head->prev->next = nullptr;
+    head->prev = head;
+    head->next = head;
+    while (node != nullptr) {
+        TimerNode* next = node->next;
+        node->prev = nullptr;
+        node->next = nullptr;
+        --scheduled;
+        place(node);
+        node = next;
+    }
+}
+
+void TimingWheel::advance(int64_t nowMs) {
+    int64_t targetTick = nowMs / granularityMs;
+    while (currentTick < targetTick) {
+        if (scheduled == 0) {
+            // 时间轮上没有定时器，直接跳到目标刻度
+            currentTick = targetTick;
+            break;
+        }
+        ++currentTick;
+
+        // 第0层转完一圈时，依次把高层当前槽位的定时器下放
+        if ((currentTick & SLOT_MASK) == 0) {
+            for (int level = 1; level < levels; ++level) {
+                int64_t index = (currentTick >> (SLOT_BITS * level)) & SLOT_MASK;
+                cascade(level, index);
+                if (index != 0) {
+                    break;
+                }
+            }
+        }
+
+        // 第0层当前槽位中的定时器全部到期
+        TimerNode* head = &slots[currentTick & SLOT_MASK];
+        while (head->next != head) {
+            TimerNode* node = head->next;
+            unlink(node);
+            --scheduled;
+            linkBefore(&expired, node);
+            node->pending = true;
+            ++expiredCount;
+        }
+    }
+}
+
+TimerNode* TimingWheel::popExpired() {
+    if (expiredCount == 0) {
+        return nullptr;
+    }
+    TimerNode* node = expired.next;
+    unlink(node);
+    node->pending = false;
+    --expiredCount;
+    return node;
+}
+
+} // namespace flow_table
@@ -0,0 +1,119 @@
+#include <cstring>
+#include "../../include/flows/tuple_hash.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define FLOW_TABLE_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define FLOW_TABLE_CRC32C_ARM 1
+#endif
+
+namespace flow_table {
+
+// 64位最终混合函数（MurmurHash3 fmix64），是一一映射，高位和低位都均匀分布
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// 组合键中两个端点的哈希值。键中的端点已经规范化排序，两个方向的四元组得到相同的键，
+// 因此这里不需要对称的组合；组合后再混合一次，使高位和低位都均匀分布：
+// 流索引使用低位选择槽位，分片使用高位选择工作线程
+static inline uint64_t combineEndpoints(uint64_t first, uint64_t second) {
+    return mix64(first ^ (second * 0x9e3779b97f4a7c15ULL + 0x632be59bd9b4e019ULL));
+}
+
+// 便携实现：计算键中一个端点（16字节地址和端口）的哈希值。
+// 端口异或到地址第8、9字节的位置：IPv4映射地址的这两个字节为0，同一子网内按序号分配的IPv6地址
+// 这两个字节通常也为0，因此这些端点在混合前互不相同，混合（一一映射）后哈希值也互不相同
+static inline uint64_t hashEndpointPortable(const uint64_t* addr, uint16_t port) {
+    return mix64((addr[1] ^ port) + addr[0] * 0x9e3779b97f4a7c15ULL);
+}
+
+static uint64_t hashFlowKeyPortable(const FlowKey& key) {
+    return combineEndpoints(hashEndpointPortable(key.addr[0], key.port[0]),
+                            hashEndpointPortable(key.addr[1], key.port[1]));
+}
+
+#if defined(FLOW_TABLE_CRC32C_X86) || defined(FLOW_TABLE_CRC32C_ARM)
+
+#if defined(FLOW_TABLE_CRC32C_X86)
+#define FLOW_TABLE_CRC32C_TARGET __attribute__((target("sse4.2")))
+FLOW_TABLE_CRC32C_TARGET static inline uint32_t crc32cWord(uint32_t crc, uint32_t value) {
+    return _mm_crc32_u32(crc, value);
+}
+#else
+#define FLOW_TABLE_CRC32C_TARGET
+static inline uint32_t crc32cWord(uint32_t crc, uint32_t value) {
+    return __crc32cw(crc, value);
+}
+#endif
+
+// 硬件实现：地址的四个32位字分两条独立的CRC链（端口异或到第三个字的低16位，即地址第8、9字节），
+// 两条链的结果拼成64位端点哈希。对固定的初值，32位输入的CRC是一一映射，因此IPv4端点（端口在一条链、
+// 地址在另一条链）的哈希值互不相同；同一子网内的IPv6主机，接口标识的两半也分别一一映射到两条链上
+FLOW_TABLE_CRC32C_TARGET static inline uint64_t hashEndpointCrc32c(const uint64_t* addr, uint16_t port) {
+    uint32_t laneA = crc32cWord(crc32cWord(0x9e3779b9u, static_cast<uint32_t>(addr[0])),
+                                static_cast<uint32_t>(addr[1]) ^ port);
+    uint32_t laneB = crc32cWord(crc32cWord(0x7f4a7c15u, static_cast<uint32_t>(addr[0] >> 32)),
+                                static_cast<uint32_t>(addr[1] >> 32));
+    return (static_cast<uint64_t>(laneB) << 32) | laneA;
+}
+
+FLOW_TABLE_CRC32C_TARGET static uint64_t hashFlowKeyCrc32c(const FlowKey& key) {
+    return combineEndpoints(hashEndpointCrc32c(key.addr[0], key.port[0]),
+                            hashEndpointCrc32c(key.addr[1], key.port[1]));
+}
+
+static bool detectCrc32c() {
+#if defined(FLOW_TABLE_CRC32C_X86)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return true;
+#endif
+}
+
+#else
+
+static bool detectCrc32c() {
+    return false;
+}
+
+static uint64_t hashFlowKeyCrc32c(const FlowKey& key) {
+    return hashFlowKeyPortable(key);
+}
+
+#endif
+
+TupleHashKind activeTupleHash() {
+    static const TupleHashKind kind = detectCrc32c() ? TupleHashKind::Crc32c : TupleHashKind::Portable;
+    return kind;
+}
+
+uint64_t hashFlowKey(const FlowKey& key) {
+    static const bool hardware = activeTupleHash() == TupleHashKind::Crc32c;
+    return hardware ? hashFlowKeyCrc32c(key) : hashFlowKeyPortable(key);
+}
+
+uint64_t hashFlowKey(const FlowKey& key, TupleHashKind kind) {
+    if (kind == TupleHashKind::Crc32c && activeTupleHash() == TupleHashKind::Crc32c) {
+        return hashFlowKeyCrc32c(key);
+    }
+    return hashFlowKeyPortable(key);
+}
+
+uint64_t hashTuple(const FourTuple& fourTuple) {
+    return hashFlowKey(FlowKey(fourTuple));
+}
+
+uint64_t hashTuple(const FourTuple& fourTuple, TupleHashKind kind) {
+    return hashFlowKey(FlowKey(fourTuple), kind);
+}
+
+} // namespace flow_table
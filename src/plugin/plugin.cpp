@@ -14,13 +14,21 @@
 // 全局变量
 
 // 内部全局变量
-static flow_table::HashFlowTable* flowTable = nullptr;
+// 每个工作线程一个流表，按TASK::Thread索引；线程只访问自己的流表，热路径上没有共享的可变状态
+static flow_table::HashFlowTable* flowTables[PLUGIN_MAX_THREADS] = {nullptr};
 // 关键词检测相关全局变量
 static AhoCorasick* acDetector = nullptr;
 static flow_table::ConfigParser* configPtr = nullptr;
 static std::string projectRoot;
 // 全局配置文件路径
 static std::string configFilePath;
+// 流表检查点文件路径前缀，每个线程的文件为"前缀.线程编号"，为空表示不保存
+static std::string checkpointPath;
+
+// 线程的检查点文件路径
+static std::string checkpointFileOf(int thread) {
+    return checkpointPath + "." + std::to_string(thread);
+}
 
 // 获取当前目录的工具函数
 std::string getCurrentDir() {
@@ -160,6 +168,12 @@ int Create(unsigned short Version, unsigned short Amount, const char *Option) {
         std::cout << "成功加载配置文件" << std::endl;
     }
     
+    // 流表检查点：Remove时保存每个线程的流，Single时恢复，插件重启后会话可以继续解析
+    checkpointPath = configPtr->getString("Flow.checkpoint_path", "");
+    if (!checkpointPath.empty()) {
+        std::cout << "流表检查点文件: " << checkpointPath << ".<线程编号>" << std::endl;
+    }
+    
     // 初始化关键词检测器
     if (!initKeywordDetector()) {
         std::cerr << "警告: 关键词检测器初始化失败" << std::endl;
@@ -177,8 +191,20 @@ int Single(unsigned short Thread, const char *Option) {
     std::cout << "线程初始化: 线程编号" << Thread << ", 选项" << (Option ? Option : "无") << std::endl;
     std::cout << "执行线程初始化..." << std::endl;
     
-    // 创建哈希流表（每个线程一个实例）
-    flowTable = new flow_table::HashFlowTable();
+    if (Thread >= PLUGIN_MAX_THREADS) {
+        std::cerr << "错误: 线程编号" << Thread << "超出支持的最大线程数" << PLUGIN_MAX_THREADS << std::endl;
+        return -1;
+    }
+    
+    // 同一线程重复初始化时释放旧的流表
+    if (flowTables[Thread] != nullptr) {
+        std::cout << "线程" << Thread << "已有流表，重新创建" << std::endl;
+        delete flowTables[Thread];
+        flowTables[Thread] = nullptr;
+    }
+    
+    // 创建哈希流表（每个线程一个实例，解析状态保存在各自流表的流中）
+    flow_table::HashFlowTable* flowTable = new flow_table::HashFlowTable();
     
     // 从配置文件中读取流超时时间（配置文件中的Flow.flow_timeout参数）
     // 默认值为120000毫秒（120秒）
@@ -194,102 +220,188 @@ int Single(unsigned short Thread, const char *Option) {
     // 设置流超时时间
     flowTable->setFlowTimeout(flowTimeoutMs);
     
+    // 从配置文件中读取最大流数量和缓冲区总字节上限，超出时淘汰最久未活动的流（0表示不限制）
+    int64_t maxFlows = 0;
+    int64_t maxBufferBytes = 0;
+    if (configPtr) {
+        maxFlows = configPtr->getInt64("Flow.max_flows", 0);
+        maxBufferBytes = configPtr->getInt64("Flow.max_buffer_bytes", 0);
+    }
+    flowTable->setMaxFlows(maxFlows > 0 ? static_cast<size_t>(maxFlows) : 0);
+    flowTable->setMaxBufferBytes(maxBufferBytes > 0 ? static_cast<size_t>(maxBufferBytes) : 0);
+    std::cout << "最大流数量: " << maxFlows << ", 缓冲区总字节上限: " << maxBufferBytes << " 字节" << std::endl;
+    
+    // 从配置文件中读取超时时间轮的刻度和覆盖范围
+    int64_t wheelGranularityMs = 1000;   // 默认1秒
+    int64_t wheelHorizonMs = 3600000;    // 默认1小时
+    if (configPtr) {
+        wheelGranularityMs = configPtr->getInt64("Flow.wheel_granularity", 1000);
+        wheelHorizonMs = configPtr->getInt64("Flow.wheel_horizon", 3600000);
+    }
+    flowTable->setTimingWheel(wheelGranularityMs, wheelHorizonMs);
+    std::cout << "超时时间轮: 刻度 " << wheelGranularityMs << " 毫秒, 覆盖范围 " << wheelHorizonMs << " 毫秒" << std::endl;
+    
+    // 从配置文件中读取缓冲区大小策略：默认大小、按服务器端口单独配置的大小和literal扩容上限
+    if (configPtr) {
+        flow_table::BufferProfile defaults;
+        defaults.c2s.initial = static_cast<size_t>(configPtr->getInt64("Buffer.c2s_initial_size", 256));
+        defaults.c2s.maximum = static_cast<size_t>(configPtr->getInt64("Buffer.c2s_buffer_size", 10 * 1024 * 1024));
+        defaults.s2c.initial = static_cast<size_t>(configPtr->getInt64("Buffer.s2c_initial_size", 256));
+        defaults.s2c.maximum = static_cast<size_t>(configPtr->getInt64("Buffer.s2c_buffer_size", 10 * 1024 * 1024));
+        defaults.mirrored = configPtr->getBool("Buffer.mirrored", false);
+        int64_t literalCeiling = configPtr->getInt64("Buffer.literal_ceiling", 0);
+        std::unique_ptr<flow_table::PortBufferSizingPolicy> sizingPolicy(
+            new flow_table::PortBufferSizingPolicy(defaults, literalCeiling > 0 ? static_cast<size_t>(literalCeiling) : 0));
+        
+        // Buffer.ports列出单独配置的端口，每个端口的大小在Buffer.port_<端口>中
+        std::stringstream portList(configPtr->getString("Buffer.ports", ""));
+        std::string port;
+        while (std::getline(portList, port, ',')) {
+            port.erase(0, port.find_first_not_of(" \t"));
+            port.erase(port.find_last_not_of(" \t") + 1);
+            if (port.empty()) {
+                continue;
+            }
+            flow_table::BufferProfile profile;
+            std::string value = configPtr->getString("Buffer.port_" + port, "");
+            if (!flow_table::PortBufferSizingPolicy::parseProfile(value, profile)) {
+                std::cerr << "警告: 端口" << port << "的缓冲区大小配置无效: " << value << std::endl;
+                continue;
+            }
+            sizingPolicy->setPortProfile(std::atoi(port.c_str()), profile);
+            std::cout << "端口" << port << "缓冲区: C2S " << profile.c2s.initial << "/" << profile.c2s.maximum
+                      << " 字节, S2C " << profile.s2c.initial << "/" << profile.s2c.maximum << " 字节" << std::endl;
+        }
+        flowTable->setBufferSizingPolicy(std::move(sizingPolicy));
+        std::cout << "literal扩容上限: " << literalCeiling << " 字节" << std::endl;
+        std::cout << "缓冲区镜像存储: " << (defaults.mirrored ? "开启" : "关闭") << std::endl;
+    }
+    
+    // 从配置文件中读取时间来源；TASK不携带时间戳，插件只支持monotonic（粗粒度单调时钟），
+    // packet（数据包时间戳）只用于提供时间戳的离线回放调用者，否则流表时钟不会前进，流永远不会超时
+    std::string timeSourceName = "monotonic";
+    if (configPtr) {
+        timeSourceName = configPtr->getString("Flow.time_source", "monotonic");
+    }
+    flow_table::TimeSourceMode timeSourceMode = flow_table::TimeSourceMode::Monotonic;
+    if (!flow_table::TimeSource::parseMode(timeSourceName, timeSourceMode)) {
+        std::cerr << "警告: 未知的时间来源 " << timeSourceName << "，使用monotonic" << std::endl;
+        timeSourceName = "monotonic";
+    } else if (timeSourceMode != flow_table::TimeSourceMode::Monotonic) {
+        std::cerr << "警告: 插件收到的数据包不携带时间戳，不支持时间来源 " << timeSourceName
+                  << "，使用monotonic" << std::endl;
+        timeSourceMode = flow_table::TimeSourceMode::Monotonic;
+        timeSourceName = "monotonic";
+    }
+    flowTable->setTimeSource(timeSourceMode);
+    std::cout << "流表时间来源: " << timeSourceName << std::endl;
+    
+    // 从配置文件中读取超时清理的间隔和每步预算，Filter每处理一个数据包检查一次是否到达间隔
+    int64_t sweepPackets = 1024;   // 默认每1024个数据包
+    int64_t sweepMs = 1000;        // 或每1秒
+    int64_t sweepBudget = 64;      // 每步最多处理64个到期的流
+    if (configPtr) {
+        sweepPackets = configPtr->getInt64("Flow.sweep_interval_packets", 1024);
+        sweepMs = configPtr->getInt64("Flow.sweep_interval_ms", 1000);
+        sweepBudget = configPtr->getInt64("Flow.sweep_budget", 64);
+    }
+    flowTable->setSweepPolicy(sweepPackets > 0 ? static_cast<uint64_t>(sweepPackets) : 0,
+                              sweepMs > 0 ? sweepMs : 0,
+                              sweepBudget > 0 ? static_cast<size_t>(sweepBudget) : 0);
+    std::cout << "超时清理: 每 " << sweepPackets << " 个数据包或每 " << sweepMs
+              << " 毫秒一步, 每步最多 " << sweepBudget << " 个流" << std::endl;
+    
+    // 恢复上次Remove时保存的流，恢复后删除检查点文件，避免下次重复恢复旧的状态
+    if (!checkpointPath.empty()) {
+        std::string checkpointFile = checkpointFileOf(Thread);
+        size_t restoredFlows = 0;
+        auto restoreStart = std::chrono::steady_clock::now();
+        if (flowTable->restoreCheckpoint(checkpointFile, restoredFlows)) {
+            double restoreMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - restoreStart).count();
+            std::cout << "从检查点恢复 " << restoredFlows << " 个流，耗时 " << restoreMs << " 毫秒" << std::endl;
+            unlink(checkpointFile.c_str());
+        }
+    }
+    
+    // 流表配置完成后再登记，Filter只会看到完整初始化的流表
+    flowTables[Thread] = flowTable;
+    
     std::cout << "线程初始化完成" << std::endl;
     
     return 0; // 成功返回0
 }
 
+// 根据源端和宿端实体创建四元组（保持数据包自身的方向）
+static FourTuple makeFourTuple(const ENTITY& source, const ENTITY& target) {
+    FourTuple fourTuple;
+    memset(&fourTuple, 0, sizeof(fourTuple));
+    fourTuple.srcIPvN = source.IPvN;
+    if (source.IPvN == 4) {
+        fourTuple.srcIPv4 = source.IPv4;
+    } else if (source.IPvN == 6) {
+        memcpy(fourTuple.srcIPv6, source.IPv6, 16);
+    }
+    fourTuple.sourcePort = source.Port;
+    fourTuple.dstIPvN = target.IPvN;
+    if (target.IPvN == 4) {
+        fourTuple.dstIPv4 = target.IPv4;
+    } else if (target.IPvN == 6) {
+        memcpy(fourTuple.dstIPv6, target.IPv6, 16);
+    }
+    fourTuple.destPort = target.Port;
+    return fourTuple;
+}
+
 // ------------------------------ 3. Filter 处理函数 ------------------------------
 // 数据过滤函数，处理每个数据包
 int Filter(TASK *Import, TASK **Export) {
     // 置动作为通告
     *Export = Import;
 
+    // 选择当前线程的流表
+    flow_table::HashFlowTable* flowTable =
+        Import->Thread < PLUGIN_MAX_THREADS ? flowTables[Import->Thread] : nullptr;
+
     switch(Import->Inform) {
         case 0X12: {
+            if (flowTable == nullptr) {
+                std::cerr << "错误: 线程" << Import->Thread << "的流表未初始化，请先调用Single()" << std::endl;
+                (*Export)->Action = 0X21;
+                break;
+            }
+            
             // 设置动作为转发
             (*Export)->Action = 0X22;
 
             // 2. 根据 TASK 中的源端和宿端创建四元组
-            FourTuple fourTuple;
-            
-            // 判断数据包方向
+            // 四元组保持数据包自身的方向，流表使用对称哈希，两个方向无需改写即可找到同一个流
             bool isC2S = (Import->Source.Role == 'C');
+            FourTuple fourTuple = makeFourTuple(Import->Source, Import->Target);
             
-            // 设置源IP和端口 - 始终保持C2S方向
-            if (isC2S) {
-                // C2S方向，正常设置
-                // 设置源IP（客户端）
-                if (Import->Source.IPvN == 4) {
-                    fourTuple.srcIPvN = 4;
-                    fourTuple.srcIPv4 = Import->Source.IPv4;
-                } else if (Import->Source.IPvN == 6) {
-                    fourTuple.srcIPvN = 6;
-                    memcpy(fourTuple.srcIPv6, Import->Source.IPv6, 16);
-                }
-                fourTuple.sourcePort = Import->Source.Port;
-                
-                // 设置目标IP（服务器）
-                if (Import->Target.IPvN == 4) {
-                    fourTuple.dstIPvN = 4;
-                    fourTuple.dstIPv4 = Import->Target.IPv4;
-                } else if (Import->Target.IPvN == 6) {
-                    fourTuple.dstIPvN = 6;
-                    memcpy(fourTuple.dstIPv6, Import->Target.IPv6, 16);
-                }
-                fourTuple.destPort = Import->Target.Port;
-            } else {
-                // S2C方向，反转方向使其成为C2S方向
-                // 设置源IP（客户端，即Target）
-                if (Import->Target.IPvN == 4) {
-                    fourTuple.srcIPvN = 4;
-                    fourTuple.srcIPv4 = Import->Target.IPv4;
-                } else if (Import->Target.IPvN == 6) {
-                    fourTuple.srcIPvN = 6;
-                    memcpy(fourTuple.srcIPv6, Import->Target.IPv6, 16);
-                }
-                fourTuple.sourcePort = Import->Target.Port;
-                
-                // 设置目标IP（服务器，即Source）
-                if (Import->Source.IPvN == 4) {
-                    fourTuple.dstIPvN = 4;
-                    fourTuple.dstIPv4 = Import->Source.IPv4;
-                } else if (Import->Source.IPvN == 6) {
-                    fourTuple.dstIPvN = 6;
-                    memcpy(fourTuple.dstIPv6, Import->Source.IPv6, 16);
-                }
-                fourTuple.destPort = Import->Source.Port;
-            }
-            
-            // 3. 创建InputPacket，只包含数据、类型和四元组
-            flow_table::InputPacket packet;
+            // 3. 创建数据包视图，载荷直接指向TASK::Buffer，处理时只复制一次（写入流的缓冲区）
+            flow_table::PacketView packet;
+            packet.data = reinterpret_cast<const char*>(Import->Buffer);
+            packet.length = Import->Length;
             
-            // 设置数据包的有效载荷
-            std::string payload(reinterpret_cast<char*>(Import->Buffer), Import->Length);
-            packet.payload = payload;
+            // 设置数据包方向（即源角色）
+            packet.direction = isC2S ? flow_table::PacketDirection::C2S : flow_table::PacketDirection::S2C;
             
-            // 设置数据包类型（即源角色）
-            packet.type = isC2S ? "C2S" : "S2C";
-            
-            // 设置四元组 - 现在四元组始终是C2S方向
+            // 设置四元组（数据包自身的方向）
             packet.fourTuple = fourTuple;
             
             // 4. 处理数据包
             bool processed = flowTable->processPacket(packet);
             
+            // 到达清理间隔时回收一部分超时的流，每步处理的数量有上限
+            flowTable->maybeSweep();
+            
             // 5. 输出处理结果并进行关键词检测
             if (processed) {
                 // 改变思路：截获输出结果并对其进行关键词检测
-                // 重定向cout到字符串流
+                // 直接输出到本线程的字符串流，不重定向全局的std::cout（多线程下是共享状态）
                 std::stringstream outputStream;
-                std::streambuf* oldCoutStreamBuf = std::cout.rdbuf();
-                std::cout.rdbuf(outputStream.rdbuf());
-                
-                // 输出处理结果到字符串流
-                flowTable->outputResults();
-                
-                // 恢复标准输出
-                std::cout.rdbuf(oldCoutStreamBuf);
+                flowTable->outputResults(outputStream);
                 
                 // 获取捕获的输出内容
                 std::string outputContent = outputStream.str();
@@ -323,6 +435,27 @@ int Filter(TASK *Import, TASK **Export) {
 
             break;
         }
+        case 0X13: {
+            // 连接关闭：解析剩余的完整消息并输出，然后立即释放流及其缓冲区
+            (*Export)->Action = 0X21;
+            if (flowTable == nullptr) {
+                break;
+            }
+            
+            std::stringstream outputStream;
+            FourTuple fourTuple = makeFourTuple(Import->Source, Import->Target);
+            if (!flowTable->closeFlow(fourTuple, outputStream)) {
+                // 连接没有传输过数据或已因LOGOUT、超时被删除
+                break;
+            }
+            
+            std::string outputContent = outputStream.str();
+            std::cout << outputContent;
+            if (!outputContent.empty()) {
+                performKeywordDetection(outputContent);
+            }
+            break;
+        }
         default:
             (*Export)->Action = 0X21;
             break;
@@ -336,15 +469,46 @@ int Filter(TASK *Import, TASK **Export) {
 void Remove() {
     std::cout << "执行清理..." << std::endl;
     
-    // 清理所有资源
-    if (flowTable != nullptr) {
+    // 输出所有线程流表的汇总统计
+    flow_table::FlowTableStats stats;
+    GetFlowStats(&stats);
+    std::cout << "流表统计: 当前流 " << stats.activeFlows << ", 新建流 " << stats.flowsCreated
+              << ", 数据包 " << stats.packets << " (流缓存命中率 " << stats.cacheHitRate() * 100 << "%)"
+              << ", 消息 " << stats.messagesParsed
+              << ", 解析错误 " << stats.parseErrors << ", 关闭 " << stats.closes
+              << ", LOGOUT删除 " << stats.logoutDeletions
+              << ", 超时 " << stats.timeouts << " (待处理 " << stats.pendingExpiry << ")"
+              << ", 淘汰 " << stats.evictions
+              << ", 缓冲区 C2S " << stats.c2sBufferBytes << "/S2C " << stats.s2cBufferBytes
+              << " 字节, 单个缓冲区峰值 " << stats.peakRingBytes << " 字节" << std::endl;
+    
+    // 清理所有线程的流表
+    for (int thread = 0; thread < PLUGIN_MAX_THREADS; thread++) {
+        flow_table::HashFlowTable* flowTable = flowTables[thread];
+        if (flowTable == nullptr) {
+            continue;
+        }
+        std::cout << "清理线程" << thread << "的流表" << std::endl;
+        
         // 获取所有流对象并输出最终结果
         flowTable->outputResults();
         
+        // 输出流对象池占用情况
+        flow_table::FlowPoolStats poolStats = flowTable->getPoolStats();
+        std::cout << "流对象池: " << poolStats.inUse << "/" << poolStats.capacity
+                  << " 个槽位正在使用，共 " << poolStats.slabs << " 块" << std::endl;
+        
+        // 保存检查点，插件重新加载后由Single恢复
+        if (!checkpointPath.empty()) {
+            if (flowTable->saveCheckpoint(checkpointFileOf(thread))) {
+                std::cout << "已保存 " << flowTable->getTotalFlows() << " 个流到检查点" << std::endl;
+            }
+        }
+        
         // 删除哈希流表
         // 用析构函数
         delete flowTable;
-        flowTable = nullptr;
+        flowTables[thread] = nullptr;
     }
     
     // 清理关键词检测器
@@ -368,3 +532,26 @@ void SetConfigFilePath(const char* path) {
         configFilePath = path;
     }
 }
+
+// 计算数据包所属的工作线程，与流表使用同一个对称哈希
+unsigned short OwnerThread(const TASK *Import, unsigned short Threads) {
+    if (Import == nullptr || Threads == 0) {
+        return 0;
+    }
+    FourTuple fourTuple = makeFourTuple(Import->Source, Import->Target);
+    return static_cast<unsigned short>(flow_table::HashFlowTable::ownerShard(fourTuple, Threads));
+}
+
+// 汇总所有线程流表的统计
+void GetFlowStats(flow_table::FlowTableStats *Stats) {
+    if (Stats == nullptr) {
+        return;
+    }
+    *Stats = flow_table::FlowTableStats();
+    for (int thread = 0; thread < PLUGIN_MAX_THREADS; thread++) {
+        // 计数器只由所属线程修改，这里只做relaxed读取，不影响工作线程
+        if (flowTables[thread] != nullptr) {
+            *Stats += flowTables[thread]->getStats();
+        }
+    }
+}
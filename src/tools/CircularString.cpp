@@ -1,111 +1,360 @@
 #include "../include/tools/CircularString.h"
+#include "../include/tools/crlf_scan.h"
 #include <algorithm>
-#include <unordered_map>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+#define CIRCULAR_STRING_MIRROR 1
+#endif
+
+namespace {
+
+#if defined(CIRCULAR_STRING_MIRROR)
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// 创建size字节的共享内存，在连续的2 * size字节地址空间中映射两次，失败时返回nullptr
+char* map_mirrored(size_t size) {
+    int fd = memfd_create("circular_string", MFD_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    char* result = nullptr;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        // 先保留整段地址空间，再把共享内存固定映射到前后两半
+        void* reserved = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved != MAP_FAILED) {
+            char* first = static_cast<char*>(reserved);
+            if (mmap(first, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                mmap(first + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED) {
+                result = first;
+            } else {
+                munmap(reserved, 2 * size);
+            }
+        }
+    }
+    // 映射保持对共享内存的引用，文件描述符不再需要
+    close(fd);
+    return result;
+}
+
+void unmap_mirrored(char* mirror, size_t size) {
+    munmap(mirror, 2 * size);
+}
+
+#else
+
+size_t page_size() {
+    return 0;
+}
+
+char* map_mirrored(size_t) {
+    return nullptr;
+}
+
+void unmap_mirrored(char*, size_t) {
+}
+
+#endif
+
+} // namespace
 
 // 将逻辑索引转换为物理索引
 size_t CircularString::physical_index(size_t logical_index) const {
-    return (head + logical_index) % capacity;
+    return (head + logical_index) % storage;
 }
 
 // 将物理索引转换为逻辑索引
-// 物理索引是从头指针开始的，逻辑索引是从0开始的
+// 物理索引是从头指针开始的，逻辑索引是从0开始的（镜像存储中物理索引可以落在第二份映射中）
 size_t CircularString::logical_index(size_t physical_index) const {
-    return (physical_index + capacity - head) % capacity;
+    return (physical_index + storage - head) % storage;
 }
 
-// 构造函数，创建指定容量的环形字符串
-CircularString::CircularString(size_t size)
-    : capacity(size), head(0), count(0) {
+const size_t CircularString::INITIAL_STORAGE;
+const size_t CircularString::npos;
+
+// 构造函数，创建指定容量的环形字符串，底层存储在首次写入时才分配
+CircularString::CircularString(size_t size, size_t initial, bool mirrored)
+    : mirror(nullptr), base(nullptr), storage(0), capacity(size),
+      initial_storage(initial == 0 ? INITIAL_STORAGE : initial), mirror_requested(mirrored), head(0), count(0) {
     if (capacity == 0) {
         throw std::invalid_argument("Capacity must be positive");
     }
-    buffer.resize(capacity);
 }
 
-// 在末尾插入字符串
-void CircularString::push_back(const std::string& str) {
-    for (char c : str) {
-        // 计算实际要插入的物理位置
-        size_t insert_pos = physical_index(count);
-
-        if (count < capacity) {
-            // 缓冲区未满，直接追加
-            buffer[insert_pos] = c;
-            ++count;
-        }
-        else {
-            // 缓冲区已满，覆盖最旧元素并移动头指针
-            buffer[insert_pos] = c;
-            head = (head + 1) % capacity; // 最旧元素被覆盖，头指针向前移动
+CircularString::CircularString(const CircularString& other)
+    : CircularString(other.capacity, other.initial_storage, other.mirror_requested) {
+    if (other.storage > 0) {
+        replace_storage(other.storage);
+        other.copy_range(0, other.count, base);
+        count = other.count;
+    }
+}
+
+CircularString::CircularString(CircularString&& other) noexcept
+    : mirror(nullptr), base(nullptr), storage(0), capacity(other.capacity),
+      initial_storage(other.initial_storage), mirror_requested(other.mirror_requested), head(0), count(0) {
+    swap(other);
+}
+
+CircularString& CircularString::operator=(CircularString other) noexcept {
+    swap(other);
+    return *this;
+}
+
+CircularString::~CircularString() {
+    release_mirror();
+}
+
+void CircularString::swap(CircularString& other) noexcept {
+    buffer.swap(other.buffer);
+    std::swap(mirror, other.mirror);
+    std::swap(base, other.base);
+    std::swap(storage, other.storage);
+    std::swap(capacity, other.capacity);
+    std::swap(initial_storage, other.initial_storage);
+    std::swap(mirror_requested, other.mirror_requested);
+    std::swap(head, other.head);
+    std::swap(count, other.count);
+}
+
+void CircularString::release_mirror() noexcept {
+    if (mirror) {
+        unmap_mirrored(mirror, storage);
+        mirror = nullptr;
+    }
+}
+
+// 按2倍增长底层存储，直到容量上限
+void CircularString::reserve_storage(size_t required) {
+    if (required <= storage || storage == capacity) {
+        return;
+    }
+    size_t new_size = std::max(std::max(storage * 2, initial_storage), required);
+    replace_storage(std::min(new_size, capacity));
+}
+
+void CircularString::replace_storage(size_t new_size) {
+    // 镜像存储以页为单位，取整后不超过容量上限时才使用
+    char* new_mirror = nullptr;
+    if (mirror_requested) {
+        size_t page = page_size();
+        size_t rounded = page == 0 ? 0 : (new_size + page - 1) / page * page;
+        if (rounded != 0 && rounded <= capacity) {
+            new_mirror = map_mirrored(rounded);
+            if (new_mirror) {
+                new_size = rounded;
+            }
         }
     }
+
+    // 新存储中把有效数据整理为从物理位置0开始
+    std::vector<char> grown;
+    char* new_base = new_mirror;
+    if (!new_mirror) {
+        grown.resize(new_size);
+        new_base = grown.data();
+    }
+    copy_range(0, count, new_base);
+
+    release_mirror();
+    buffer.swap(grown);
+    mirror = new_mirror;
+    base = new_base;
+    storage = new_size;
+    head = 0;
 }
 
-// 查找第n次出现的字符串（Sunday算法优化）
-size_t CircularString::find_nth(const std::string& target, size_t n) const {
-    if (target.empty()) {
-        throw std::invalid_argument("查找目标不能为空字符串");
+void CircularString::copy_range(size_t m, size_t length, char* dest) const {
+    if (length == 0) {
+        return;
     }
+    size_t start = physical_index(m);
+    // 镜像存储中任意范围都连续，堆存储中跨过末尾时分两段复制
+    size_t first = mirror ? length : std::min(length, storage - start);
+    memcpy(dest, base + start, first);
+    memcpy(dest + first, base, length - first);
+}
 
-    const size_t target_len = target.length();
-    const size_t buffer_len = count;
+// 在末尾插入字符串
+void CircularString::push_back(const std::string& str) {
+    push_back(str.data(), str.size());
+}
 
-    if (target_len > buffer_len) {
-        throw std::out_of_range("字符串未找到足够次数");
+void CircularString::push_back(const char* data, size_t length) {
+    if (length == 0) {
+        return;
     }
+    // 存储不足时先增长，达到容量上限后才覆盖旧元素
+    reserve_storage(count + length);
 
-    // Sunday算法预处理坏字符表
-    std::unordered_map<char, size_t> bad_char_shift;
-    for (size_t i = 0; i < target_len; ++i) {
-        bad_char_shift[target[i]] = target_len - i;
+    // 数据比整个存储还长时，只有最后storage个字节会留下
+    if (length >= storage) {
+        memcpy(base, data + (length - storage), storage);
+        head = 0;
+        count = storage;
+        return;
     }
 
-    size_t occurrences = 0;
-    size_t current = 0;
+    // 从尾部位置开始最多复制两段：到存储末尾的一段和从存储开头继续的一段，
+    // 镜像存储中写入第二份映射的字节同时出现在存储开头，一次复制即可
+    size_t tail = head + count;
+    if (tail >= storage) {
+        tail -= storage;
+    }
+    size_t first = mirror ? length : std::min(length, storage - tail);
+    memcpy(base + tail, data, first);
+    memcpy(base, data + first, length - first);
 
-    while (current <= buffer_len - target_len) {
-        size_t j;
-        // 检查匹配
-        for (j = 0; j < target_len; ++j) {
-            const size_t phys_idx = physical_index(current + j);
-            if (buffer[phys_idx] != target[j]) break;
+    // 超出存储的部分覆盖了最旧的元素，头指针一次性前移
+    size_t total = count + length;
+    if (total > storage) {
+        head += total - storage;
+        if (head >= storage) {
+            head -= storage;
         }
+        count = storage;
+    } else {
+        count = total;
+    }
+}
 
-        if (j == target_len) {
-            if (++occurrences == n) {
-                return current;
-            }
-            current += 1; // 找到匹配后移动1位继续查找
+// 查找第n次出现的字符串，每次调用都建立查找器；反复查找同一个字符串时应复用SubstringSearcher
+size_t CircularString::find_nth(const std::string& target, size_t n) const {
+    return find_nth(SubstringSearcher(target), n);
+}
+
+size_t CircularString::find_nth(const SubstringSearcher& searcher, size_t n) const {
+    size_t occurrences = 0;
+    size_t current = 0;
+    while (n > 0) {
+        size_t position = search(searcher, current);
+        if (position == npos) {
+            break;
         }
-        else {
-            // 计算跳跃步长
-            const size_t next_char_pos = current + target_len;
-            if (next_char_pos >= buffer_len) break;
-
-            const char next_char = buffer[physical_index(next_char_pos)];
-            current += bad_char_shift.count(next_char) ?
-                bad_char_shift[next_char] :
-                target_len + 1;
+        if (++occurrences == n) {
+            return position;
         }
+        current = position + 1; // 找到匹配后移动1位继续查找
     }
-
     throw std::out_of_range("字符串未找到足够次数");
 }
 
+size_t CircularString::search(const SubstringSearcher& searcher, size_t start_index) const {
+    const size_t target_len = searcher.size();
+    if (start_index >= count || count - start_index < target_len) {
+        return npos;
+    }
+    Segment parts[2];
+    size_t part_count = segments(start_index, count - 1, parts);
+    size_t offset = searcher.find(parts[0].data, parts[0].length);
+    if (offset != SubstringSearcher::npos) {
+        return start_index + offset;
+    }
+    if (part_count == 1) {
+        return npos;
+    }
+
+    // 跨过存储末尾的出现位置：首字节在第一段的最后target_len - 1个字节中，
+    // 就地分两部分比较（第一段末尾和第二段开头），不拼接临时字符串
+    const char* needle = searcher.needle().data();
+    size_t before = std::min(target_len - 1, parts[0].length);
+    for (size_t k = parts[0].length - before; k < parts[0].length; ++k) {
+        size_t head = parts[0].length - k;
+        size_t tail = target_len - head;
+        if (tail <= parts[1].length && memcmp(parts[0].data + k, needle, head) == 0 &&
+            memcmp(parts[1].data, needle + head, tail) == 0) {
+            return start_index + k;
+        }
+    }
+
+    offset = searcher.find(parts[1].data, parts[1].length);
+    if (offset != SubstringSearcher::npos) {
+        return start_index + parts[0].length + offset;
+    }
+    return npos;
+}
+
 // 获取子字符串[m, n]
 std::string CircularString::substring(size_t m, size_t n) const {
     if (m > n || n >= count) {
         throw std::out_of_range("Invalid index range");
     }
 
-    std::string result;
-    result.reserve(n - m + 1);
-    for (size_t i = m; i <= n; ++i) {
-        result.push_back(buffer[physical_index(i)]);
-    }
+    std::string result(n - m + 1, '\0');
+    copy_range(m, n - m + 1, &result[0]);
     return result;
 }
 
+const char* CircularString::contiguous(size_t m, size_t n) const {
+    Segment parts[2];
+    return segments(m, n, parts) == 1 ? parts[0].data : nullptr;
+}
+
+size_t CircularString::segments(size_t m, size_t n, Segment out[2]) const {
+    if (m > n || n >= count) {
+        throw std::out_of_range("Invalid index range");
+    }
+    size_t start = physical_index(m);
+    size_t length = n - m + 1;
+    size_t first = mirror ? length : std::min(length, storage - start);
+    out[0].data = base + start;
+    out[0].length = first;
+    if (first == length) {
+        return 1;
+    }
+    out[1].data = base;
+    out[1].length = length - first;
+    return 2;
+}
+
+void CircularString::append_to(std::string& out, size_t m, size_t n) const {
+    Segment parts[2];
+    size_t part_count = segments(m, n, parts);
+    for (size_t i = 0; i < part_count; ++i) {
+        out.append(parts[i].data, parts[i].length);
+    }
+}
+
+CircularString::Reader::Reader(const CircularString& ring, size_t m, size_t n)
+    : part_count(ring.segments(m, n, parts)), part(0), offset(0) {
+}
+
+bool CircularString::Reader::next_segment(Segment& segment) {
+    while (part < part_count) {
+        if (offset < parts[part].length) {
+            segment.data = parts[part].data + offset;
+            segment.length = parts[part].length - offset;
+            ++part;
+            offset = 0;
+            return true;
+        }
+        ++part;
+        offset = 0;
+    }
+    return false;
+}
+
+size_t CircularString::Reader::remaining() const noexcept {
+    size_t result = 0;
+    for (size_t i = part; i < part_count; ++i) {
+        result += parts[i].length;
+    }
+    return part < part_count ? result - offset : 0;
+}
+
+bool CircularString::is_mirrored() const noexcept {
+    return mirror != nullptr;
+}
+
 // 删除k及之前的所有元素
 void CircularString::erase_up_to(size_t k) {
     if (k >= count) {
@@ -127,15 +376,27 @@ size_t CircularString::cap() const noexcept {
     return capacity;
 }
 
+// 提高缓冲区容量上限
+void CircularString::grow_capacity(size_t new_capacity) {
+    if (new_capacity > capacity) {
+        capacity = new_capacity;
+    }
+}
+
+// 获取底层存储实际占用的字节数
+size_t CircularString::memory_usage() const noexcept {
+    return storage;
+}
+
 char CircularString::at(size_t index) {
     if (index >= count) {
         throw std::out_of_range("Input index of At() is out of range");
     }
-    return buffer[physical_index(index)];
+    return base[physical_index(index)];
 }
 
 size_t CircularString::find(size_t start_index, size_t end_index, const char target) {
-    std::vector<char>::iterator target_it;
+    const char* target_it;
     if (start_index >= end_index) {
         return size_t(-1);
     }
@@ -147,32 +408,58 @@ size_t CircularString::find(size_t start_index, size_t end_index, const char tar
     }
     size_t physical_start_index = physical_index(start_index);
     size_t physical_end_index = physical_index(end_index);
-    //缓冲区没循环的情况下，std::find()一次
-    if (physical_start_index <= physical_end_index) {
-        target_it = std::find(buffer.begin() + physical_start_index, buffer.begin() + physical_end_index, target);
-        if (target_it == buffer.begin() + physical_end_index) {
+    //缓冲区没循环或使用镜像存储的情况下，std::find()一次
+    //（缓冲区写满时起止物理位置可能相同，需按长度判断是否跨过存储末尾）
+    if (mirror || physical_start_index + (end_index - start_index) <= storage) {
+        physical_end_index = physical_start_index + (end_index - start_index);
+        target_it = std::find(base + physical_start_index, base + physical_end_index, target);
+        if (target_it == base + physical_end_index) {
             return -1;
         }
         else {
-            return logical_index(target_it - buffer.begin());
+            return logical_index(target_it - base);
         }
     }
     //缓冲区循环的情况下，std::find()两次
     else {
-        target_it = std::find(buffer.begin() + physical_start_index, buffer.end(), target); //先找后半段
-        if (target_it == buffer.end()) {
-            target_it = std::find(buffer.begin(), buffer.begin() + physical_end_index, target);   //后半段找不到再找前半段
-            if (target_it == buffer.begin() + physical_end_index) {
+        target_it = std::find(base + physical_start_index, base + storage, target); //先找后半段
+        if (target_it == base + storage) {
+            target_it = std::find(base, base + physical_end_index, target);   //后半段找不到再找前半段
+            if (target_it == base + physical_end_index) {
                 return -1;
             }
             else {
-                return logical_index(target_it - buffer.begin());
+                return logical_index(target_it - base);
             }
         }
         else {
-            return logical_index(target_it - buffer.begin());
+            return logical_index(target_it - base);
         }
     }
 
 
 }
+
+size_t CircularString::find_crlf(size_t start_index) const noexcept {
+    if (start_index + 1 >= count) {
+        return npos;
+    }
+    Segment parts[2];
+    size_t part_count = segments(start_index, count - 1, parts);
+    size_t offset = scan_crlf(parts[0].data, parts[0].length);
+    if (offset < parts[0].length) {
+        return start_index + offset;
+    }
+    if (part_count == 1) {
+        return npos;
+    }
+    // 堆存储中跨过存储末尾：先检查第一段的最后一个字节和第二段的第一个字节，再查找第二段
+    if (parts[0].data[parts[0].length - 1] == '\r' && parts[1].data[0] == '\n') {
+        return start_index + parts[0].length - 1;
+    }
+    offset = scan_crlf(parts[1].data, parts[1].length);
+    if (offset < parts[1].length) {
+        return start_index + parts[0].length + offset;
+    }
+    return npos;
+}
@@ -0,0 +1,95 @@
+#include "../include/tools/crlf_scan.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CRLF_SCAN_X86 1
+#endif
+
+namespace {
+
+// 逐字节查找[from, length)中第一个"\r\n"
+size_t scan_crlf_scalar(const char* data, size_t from, size_t length) {
+    for (size_t i = from; i + 1 < length; ++i) {
+        if (data[i] == '\r' && data[i + 1] == '\n') {
+            return i;
+        }
+    }
+    return length;
+}
+
+#if defined(CRLF_SCAN_X86)
+
+// 每次检查16个位置：第i个位置是'\r'且第i + 1个位置是'\n'，需要读取17个字节
+size_t scan_crlf_sse2(const char* data, size_t length) {
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 17 <= length; i += 16) {
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(current, cr), _mm_cmpeq_epi8(next, lf)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+        }
+    }
+    return scan_crlf_scalar(data, i, length);
+}
+
+__attribute__((target("avx2"))) size_t scan_crlf_avx2(const char* data, size_t length) {
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 33 <= length; i += 32) {
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+        int mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(current, cr),
+                                                         _mm256_cmpeq_epi8(next, lf)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+        }
+    }
+    return scan_crlf_scalar(data, i, length);
+}
+
+CrlfScanKind detect_crlf_scan() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? CrlfScanKind::Avx2 : CrlfScanKind::Sse2;
+}
+
+#else
+
+size_t scan_crlf_sse2(const char* data, size_t length) {
+    return scan_crlf_scalar(data, 0, length);
+}
+
+size_t scan_crlf_avx2(const char* data, size_t length) {
+    return scan_crlf_scalar(data, 0, length);
+}
+
+CrlfScanKind detect_crlf_scan() {
+    return CrlfScanKind::Scalar;
+}
+
+#endif
+
+} // namespace
+
+CrlfScanKind active_crlf_scan() {
+    static const CrlfScanKind kind = detect_crlf_scan();
+    return kind;
+}
+
+size_t scan_crlf(const char* data, size_t length) {
+    return scan_crlf(data, length, active_crlf_scan());
+}
+
+size_t scan_crlf(const char* data, size_t length, CrlfScanKind kind) {
+    CrlfScanKind active = active_crlf_scan();
+    if (kind == CrlfScanKind::Avx2 && active == CrlfScanKind::Avx2) {
+        return scan_crlf_avx2(data, length);
+    }
+    if (kind != CrlfScanKind::Scalar && active != CrlfScanKind::Scalar) {
+        return scan_crlf_sse2(data, length);
+    }
+    return scan_crlf_scalar(data, 0, length);
+}
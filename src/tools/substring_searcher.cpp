@@ -0,0 +1,68 @@
+#include "../include/tools/substring_searcher.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define SUBSTRING_SEARCHER_SSE2 1
+#endif
+
+const size_t SubstringSearcher::npos;
+
+SubstringSearcher::SubstringSearcher(const std::string& needle) : pattern(needle) {
+    if (pattern.empty()) {
+        throw std::invalid_argument("查找目标不能为空字符串");
+    }
+    // Sunday算法：不在目标字符串中的字节跳过整个窗口，否则对齐到该字节最后一次出现的位置
+    const size_t m = pattern.size();
+    for (size_t c = 0; c < 256; ++c) {
+        shift[c] = m + 1;
+    }
+    for (size_t i = 0; i < m; ++i) {
+        shift[static_cast<unsigned char>(pattern[i])] = m - i;
+    }
+}
+
+size_t SubstringSearcher::find(const char* data, size_t length, size_t from) const noexcept {
+    const size_t m = pattern.size();
+    if (from > length || length - from < m) {
+        return npos;
+    }
+    const char* needle = pattern.data();
+    if (m == 1) {
+        const void* found = memchr(data + from, needle[0], length - from);
+        return found ? static_cast<size_t>(static_cast<const char*>(found) - data) : npos;
+    }
+
+    size_t i = from;
+#if defined(SUBSTRING_SEARCHER_SSE2)
+    // 每次检查16个候选位置：位置i的字节等于首字节且位置i + m - 1的字节等于末字节
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    for (; i + m - 1 + 16 <= length; i += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + m - 1));
+        unsigned int mask = static_cast<unsigned int>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+        while (mask != 0) {
+            size_t candidate = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (memcmp(data + candidate + 1, needle + 1, m - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // Sunday算法：先比较末字节，不匹配时按窗口之后的字节查表跳跃
+    while (i + m <= length) {
+        if (data[i + m - 1] == needle[m - 1] && memcmp(data + i, needle, m - 1) == 0) {
+            return i;
+        }
+        if (i + m == length) {
+            break;
+        }
+        i += shift[static_cast<unsigned char>(data[i + m])];
+    }
+    return npos;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file test_buffer_sizing.cpp
+ * @brief 缓冲区大小策略测试
+ *
+ * 本测试文件验证PortBufferSizingPolicy按服务器端口和方向分配缓冲区大小，
+ * 以及流表根据IMAP literal声明扩容缓冲区并学习literal大小。
+ *
+ * 主要测试功能：
+ * 1. 配置解析测试 - "C2S初始,C2S上限,S2C初始,S2C上限"格式的有效和无效输入
+ * 2. literal跟踪测试 - 行尾{N}\r\n和{N+}\r\n声明的识别，跳过literal内容中形如声明的文本
+ * 3. 按端口分配测试 - 不同端口的流使用各自的初始大小和容量上限
+ * 4. literal扩容测试 - FETCH响应和APPEND命令中的literal使缓冲区扩容，且不超过literal上限
+ * 5. 学习测试 - 观察到literal后，同一端口新建的流使用更大的初始大小和容量上限
+ * 6. 邮件正文测试 - 正文中形如literal声明的文本不扩容缓冲区，也不影响端口的学习结果
+ */
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/flows/buffer_sizing.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 生成客户端到服务器方向的IPv4四元组
+FourTuple makeTuple(int clientPort, int serverPort) {
+    FourTuple tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    tuple.srcIPvN = 4;
+    tuple.dstIPvN = 4;
+    tuple.srcIPv4 = 0x0A000001u;
+    tuple.dstIPv4 = 0xC0A80001u;
+    tuple.sourcePort = clientPort;
+    tuple.destPort = serverPort;
+    return tuple;
+}
+
+// 生成指向payload的数据包视图（四元组为数据包自身方向）
+PacketView makeView(const FourTuple& c2sTuple, PacketDirection direction, const std::string& payload) {
+    PacketView view;
+    view.data = payload.data();
+    view.length = payload.size();
+    view.direction = direction;
+    view.fourTuple = direction == PacketDirection::C2S ? c2sTuple : c2sTuple.reversed();
+    return view;
+}
+
+BufferProfile makeProfile(size_t c2sInitial, size_t c2sMaximum, size_t s2cInitial, size_t s2cMaximum) {
+    BufferProfile profile;
+    profile.c2s.initial = c2sInitial;
+    profile.c2s.maximum = c2sMaximum;
+    profile.s2c.initial = s2cInitial;
+    profile.s2c.maximum = s2cMaximum;
+    return profile;
+}
+
+// 配置解析
+bool test_parse_profile() {
+    std::cout << "\n[配置解析测试]" << std::endl;
+    BufferProfile profile;
+    TEST_ASSERT(PortBufferSizingPolicy::parseProfile("256,1048576,4096,10485760", profile), "解析有效配置");
+    TEST_ASSERT(profile.c2s.initial == 256 && profile.c2s.maximum == 1048576 &&
+                profile.s2c.initial == 4096 && profile.s2c.maximum == 10485760, "四个字段依次为两个方向的初始大小和上限");
+    TEST_ASSERT(PortBufferSizingPolicy::parseProfile(" 128 , 1024 ,512,2048 ", profile) &&
+                profile.c2s.initial == 128 && profile.s2c.maximum == 2048, "允许字段两侧有空格");
+
+    BufferProfile unchanged = profile;
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("", profile), "空字符串无效");
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("1,2,3", profile), "字段不足无效");
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("1,2,3,4,5", profile), "字段过多无效");
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("1,2,,4", profile), "空字段无效");
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("1,2,-3,4", profile), "负数无效");
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("1,2,0,4", profile), "零无效");
+    TEST_ASSERT(!PortBufferSizingPolicy::parseProfile("1k,2,3,4", profile), "非数字无效");
+    TEST_ASSERT(profile.c2s.initial == unchanged.c2s.initial && profile.s2c.maximum == unchanged.s2c.maximum,
+                "无效配置不修改解析结果");
+    return true;
+}
+
+// literal跟踪
+bool test_literal_tracker() {
+    std::cout << "\n[literal跟踪测试]" << std::endl;
+    size_t size = 0;
+    std::string data = "a1 APPEND INBOX {123}\r\n";
+    LiteralTracker append;
+    TEST_ASSERT(append.feed(data.data(), data.size(), size) && size == 123 && append.remaining() == 123,
+                "识别行尾的{N}\\r\\n");
+    data = "a2 APPEND INBOX (\\Seen) {12+}\r\n";
+    LiteralTracker nonSync;
+    TEST_ASSERT(nonSync.feed(data.data(), data.size(), size) && size == 12, "识别非同步literal{N+}\\r\\n");
+    data = "* 1 FETCH (BODY[HEADER] {10}\r\n0123456789 BODY[TEXT] {2048}\r\n";
+    LiteralTracker multiple;
+    TEST_ASSERT(multiple.feed(data.data(), data.size(), size) && size == 2048, "多个声明时返回最后一个");
+
+    // 声明被拆到两个数据包中
+    LiteralTracker split;
+    data = "a3 APPEND INBOX {40";
+    TEST_ASSERT(!split.feed(data.data(), data.size(), size), "行未结束时不识别");
+    data = "96}\r\n";
+    TEST_ASSERT(split.feed(data.data(), data.size(), size) && size == 4096, "跨数据包的声明");
+
+    size = 7;
+    LiteralTracker invalid;
+    data = "a4 SEARCH {abc}\r\n";
+    TEST_ASSERT(!invalid.feed(data.data(), data.size(), size), "花括号内不是数字时不识别");
+    data = "a5 SEARCH TEXT {12} UNSEEN\r\n";
+    TEST_ASSERT(!invalid.feed(data.data(), data.size(), size), "不在行尾的声明不识别");
+    data = "{}\r\n{1234567890123}\r\n{";
+    TEST_ASSERT(!invalid.feed(data.data(), data.size(), size), "空花括号、过长的数字和末尾的花括号不识别");
+    TEST_ASSERT(size == 7 && invalid.remaining() == 0, "未识别时不修改结果");
+
+    // literal内容中形如声明的文本不识别，literal结束后的声明照常识别
+    LiteralTracker body;
+    const std::string content = "Subject: x\r\n{999999999}\r\n";
+    data = "* 1 FETCH (BODY[] {" + std::to_string(content.size()) + "}\r\n" + content.substr(0, 12);
+    TEST_ASSERT(body.feed(data.data(), data.size(), size) && size == content.size(), "识别FETCH中的literal");
+    data = content.substr(12) + ")\r\n* 2 FETCH (BODY[] {5}\r\n";
+    TEST_ASSERT(body.feed(data.data(), data.size(), size) && size == 5, "literal内容中的声明不识别，之后的声明识别");
+    return true;
+}
+
+// 不同端口的流使用各自的缓冲区大小
+bool test_port_profiles() {
+    std::cout << "\n[按端口分配测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t imapC2SCapacity, imapS2CCapacity, otherC2SCapacity, otherS2CCapacity;
+    size_t imapBytes, otherBytes, uniformC2SCapacity, uniformS2CCapacity;
+    {
+        HashFlowTable flowTable;
+        std::unique_ptr<PortBufferSizingPolicy> policy(
+            new PortBufferSizingPolicy(makeProfile(256, 4096, 256, 4096)));
+        policy->setPortProfile(143, makeProfile(128, 1024, 512, 8192));
+        flowTable.setBufferSizingPolicy(std::move(policy));
+
+        FourTuple imap = makeTuple(40000, 143);
+        FourTuple other = makeTuple(40001, 110);
+        flowTable.processPacket(makeView(imap, PacketDirection::C2S, "a1 NOOP\r\n"));
+        flowTable.processPacket(makeView(other, PacketDirection::C2S, "a1 NOOP\r\n"));
+
+        Flow* imapFlow = flowTable.getOrCreateFlow(imap, true);
+        Flow* otherFlow = flowTable.getOrCreateFlow(other, true);
+        imapC2SCapacity = imapFlow->getBufferCapacity(PacketDirection::C2S);
+        imapS2CCapacity = imapFlow->getBufferCapacity(PacketDirection::S2C);
+        otherC2SCapacity = otherFlow->getBufferCapacity(PacketDirection::C2S);
+        otherS2CCapacity = otherFlow->getBufferCapacity(PacketDirection::S2C);
+        imapBytes = imapFlow->getBufferBytes();
+        otherBytes = otherFlow->getBufferBytes();
+
+        // setBufferSizes设置所有端口统一的容量上限
+        flowTable.setBufferSizes(2048, 16384);
+        Flow* uniformFlow = flowTable.getOrCreateFlow(makeTuple(40002, 143), true);
+        uniformC2SCapacity = uniformFlow->getBufferCapacity(PacketDirection::C2S);
+        uniformS2CCapacity = uniformFlow->getBufferCapacity(PacketDirection::S2C);
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(imapC2SCapacity == 1024 && imapS2CCapacity == 8192, "143端口使用单独配置的容量上限");
+    TEST_ASSERT(otherC2SCapacity == 4096 && otherS2CCapacity == 4096, "其他端口使用默认容量上限");
+    TEST_ASSERT(imapBytes == 128, "143端口首次写入分配单独配置的初始大小");
+    TEST_ASSERT(otherBytes == 256, "其他端口首次写入分配默认初始大小");
+    TEST_ASSERT(uniformC2SCapacity == 2048 && uniformS2CCapacity == 16384, "setBufferSizes替换为统一的大小");
+    return true;
+}
+
+// literal使缓冲区扩容，并学习literal大小
+bool test_literal_growth_and_learning() {
+    std::cout << "\n[literal扩容和学习测试]" << std::endl;
+    const size_t ceiling = 1024 * 1024;
+    const size_t fetchLiteral = 100000;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t fetchCapacity, fetchBuffered, appendCapacity, untouchedCapacity;
+    size_t learnedS2CCapacity, learnedS2CBytes, otherS2CCapacity;
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizingPolicy(std::unique_ptr<BufferSizingPolicy>(
+            new PortBufferSizingPolicy(makeProfile(256, 4096, 256, 8192), ceiling)));
+
+        // FETCH响应中的literal：S2C缓冲区扩容到能容纳整个literal
+        FourTuple first = makeTuple(40000, 143);
+        flowTable.processPacket(makeView(first, PacketDirection::S2C, "* 1 FETCH (RFC822 {100000}\r\n"));
+        const std::string chunk(1000, 'x');
+        for (size_t sent = 0; sent < fetchLiteral; sent += chunk.size()) {
+            flowTable.processPacket(makeView(first, PacketDirection::S2C, chunk));
+        }
+        Flow* firstFlow = flowTable.getOrCreateFlow(first, true);
+        fetchCapacity = firstFlow->getBufferCapacity(PacketDirection::S2C);
+        fetchBuffered = firstFlow->getBufferedBytes(PacketDirection::S2C);
+        untouchedCapacity = firstFlow->getBufferCapacity(PacketDirection::C2S);
+
+        // APPEND命令中超过literal上限的literal：C2S缓冲区只扩容到literal上限
+        FourTuple second = makeTuple(40001, 993);
+        flowTable.processPacket(makeView(second, PacketDirection::C2S, "a2 APPEND INBOX {5000000}\r\n"));
+        appendCapacity = flowTable.getOrCreateFlow(second, true)->getBufferCapacity(PacketDirection::C2S);
+
+        // 同一端口新建的流按观察到的literal大小分配
+        FourTuple third = makeTuple(40002, 143);
+        flowTable.processPacket(makeView(third, PacketDirection::S2C, "* OK\r\n"));
+        Flow* thirdFlow = flowTable.getOrCreateFlow(third, true);
+        learnedS2CCapacity = thirdFlow->getBufferCapacity(PacketDirection::S2C);
+        learnedS2CBytes = thirdFlow->getBufferBytes();
+
+        // 没有观察到literal的端口不受影响
+        otherS2CCapacity = flowTable.getOrCreateFlow(makeTuple(40003, 110), true)->getBufferCapacity(PacketDirection::S2C);
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(fetchCapacity >= fetchLiteral + LITERAL_HEADROOM, "S2C缓冲区扩容到能容纳literal");
+    TEST_ASSERT(fetchBuffered >= fetchLiteral, "literal数据没有被环形缓冲区覆盖");
+    TEST_ASSERT(untouchedCapacity == 4096, "另一个方向的容量上限不变");
+    TEST_ASSERT(appendCapacity == ceiling, "扩容不超过literal上限");
+    TEST_ASSERT(learnedS2CCapacity >= fetchLiteral + LITERAL_HEADROOM, "新建流的容量上限能容纳见过的最大literal");
+    TEST_ASSERT(learnedS2CBytes >= fetchLiteral + LITERAL_HEADROOM, "新建流首次写入就分配能容纳典型literal的存储");
+    TEST_ASSERT(otherS2CCapacity == 8192, "其他端口的新建流使用默认容量上限");
+    return true;
+}
+
+// 邮件正文中形如literal声明的文本不影响扩容和学习
+bool test_literal_in_body() {
+    std::cout << "\n[邮件正文测试]" << std::endl;
+    const size_t ceiling = 1024 * 1024;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t s2cCapacity, c2sCapacity, learnedS2CCapacity, learnedC2SCapacity;
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizingPolicy(std::unique_ptr<BufferSizingPolicy>(
+            new PortBufferSizingPolicy(makeProfile(256, 4096, 256, 8192), ceiling)));
+
+        // FETCH响应的literal内容（单独的数据包）中含有{999999999}\r\n
+        FourTuple tuple = makeTuple(40000, 143);
+        const std::string content = "Subject: test\r\n\r\n{999999999}\r\n";
+        flowTable.processPacket(makeView(tuple, PacketDirection::S2C,
+                                         "* 1 FETCH (RFC822 {" + std::to_string(content.size()) + "}\r\n"));
+        flowTable.processPacket(makeView(tuple, PacketDirection::S2C, content));
+        flowTable.processPacket(makeView(tuple, PacketDirection::S2C, ")\r\n"));
+
+        // APPEND的literal内容中含有同样的文本
+        flowTable.processPacket(makeView(tuple, PacketDirection::C2S,
+                                         "a1 APPEND INBOX {" + std::to_string(content.size()) + "+}\r\n"));
+        flowTable.processPacket(makeView(tuple, PacketDirection::C2S, content + "\r\n"));
+
+        Flow* flow = flowTable.getOrCreateFlow(tuple, true);
+        s2cCapacity = flow->getBufferCapacity(PacketDirection::S2C);
+        c2sCapacity = flow->getBufferCapacity(PacketDirection::C2S);
+
+        Flow* later = flowTable.getOrCreateFlow(makeTuple(40001, 143), true);
+        learnedS2CCapacity = later->getBufferCapacity(PacketDirection::S2C);
+        learnedC2SCapacity = later->getBufferCapacity(PacketDirection::C2S);
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(s2cCapacity < ceiling && c2sCapacity < ceiling, "正文中的文本不使缓冲区扩容到literal上限");
+    TEST_ASSERT(learnedS2CCapacity < ceiling && learnedC2SCapacity < ceiling, "同一端口新建的流不受正文中的文本影响");
+    return true;
+}
+
+// 不设置literal上限时不扩容
+bool test_no_ceiling() {
+    std::cout << "\n[禁用literal扩容测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t capacity;
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizes(4096, 4096);
+        FourTuple tuple = makeTuple(40000, 143);
+        flowTable.processPacket(makeView(tuple, PacketDirection::C2S, "a1 APPEND INBOX {100000}\r\n"));
+        capacity = flowTable.getOrCreateFlow(tuple, true)->getBufferCapacity(PacketDirection::C2S);
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(capacity == 4096, "literal上限为0时缓冲区保持配置的容量上限");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 缓冲区大小策略测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_parse_profile();
+    allPassed &= test_literal_tracker();
+    allPassed &= test_port_profiles();
+    allPassed &= test_literal_growth_and_learning();
+    allPassed &= test_literal_in_body();
+    allPassed &= test_no_ceiling();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
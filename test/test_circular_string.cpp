@@ -13,6 +13,12 @@
  * 5. erase_up_to方法测试 - 验证数据删除功能
  * 6. 环形覆盖逻辑测试 - 验证当数据超过容量时的覆盖行为
  * 7. 大规模测试 - 验证在大量数据下的稳定性
+ * 8. 按需增长测试 - 验证底层存储从零开始按2倍增长到容量上限
+ * 9. 批量写入测试 - 在各种长度和回绕位置上与逐字节追加的参考模型比较
+ * 10. 镜像存储测试 - 验证跨过存储末尾的范围也是连续内存，以及容量不是页大小倍数时退回堆存储
+ * 11. 内存段测试 - 验证segments()、append_to()和Reader在回绕和不回绕时按逻辑顺序返回数据
+ * 12. find_crlf测试 - 验证跨过存储末尾的回车换行、单独的\r和不完整的数据
+ * 13. 预编译查找器测试 - 验证SubstringSearcher在连续内存和跨过存储末尾时的查找结果，以及复用查找器
  * 
  * 该测试使用自定义的TEST_ASSERT宏进行断言检查，确保各项功能符合预期。
  */
@@ -22,6 +28,7 @@
 #include <cassert>
 #include <stdexcept>
 #include <iomanip> // 用于格式化输出
+#include <string>
 
 // 简单的断言宏，用于测试
 #define TEST_ASSERT(condition, message) \
@@ -320,6 +327,322 @@ bool test_large_scale() {
     return true;
 }
 
+// 按需增长测试
+bool test_growth() {
+    std::cout << "\n[按需增长测试]" << std::endl;
+
+    const size_t CAPACITY = 10 * 1024 * 1024;
+    std::cout << "- 创建容量为" << CAPACITY << "的环形字符串" << std::endl;
+    CircularString cs(CAPACITY);
+    TEST_ASSERT(cs.cap() == CAPACITY, "容量上限应为10MB");
+    TEST_ASSERT(cs.memory_usage() == 0, "构造时不应分配底层存储");
+
+    cs.push_back("a1 LOGIN user pass\r\n");
+    TEST_ASSERT(cs.memory_usage() > 0 && cs.memory_usage() <= 256, "少量数据只分配很小的存储");
+    TEST_ASSERT(cs.find(0, cs.size(), '\r') == 18, "增长后查找结果正确");
+
+    // 写入1MB数据，存储按2倍增长
+    std::string chunk(4096, 'x');
+    for (int i = 0; i < 256; ++i) {
+        cs.push_back(chunk);
+    }
+    TEST_ASSERT(cs.size() == 20 + 256 * 4096, "数据未达到上限时不覆盖");
+    TEST_ASSERT(cs.memory_usage() >= cs.size() && cs.memory_usage() <= 2 * cs.size(), "存储不超过数据量的2倍");
+    TEST_ASSERT(cs.substring(0, 19) == "a1 LOGIN user pass\r\n", "增长后旧数据保持不变");
+
+    // 先删除部分数据让头指针移动，再增长，验证整理后的顺序
+    std::cout << "- 测试头指针移动后的增长" << std::endl;
+    CircularString small(1000);
+    small.push_back(std::string(200, 'a'));
+    small.erase_up_to(149);
+    small.push_back(std::string(100, 'b'));   // 物理上跨过存储末尾
+    small.push_back(std::string(300, 'c'));   // 触发增长
+    TEST_ASSERT(small.size() == 450, "大小应为450");
+    TEST_ASSERT(small.substring(0, 49) == std::string(50, 'a'), "最旧的数据在前");
+    TEST_ASSERT(small.substring(50, 149) == std::string(100, 'b'), "中间数据顺序正确");
+    TEST_ASSERT(small.find(0, small.size(), 'c') == 150, "跨过增长边界的查找正确");
+
+    // 达到上限后恢复覆盖语义
+    std::cout << "- 测试达到上限后的覆盖" << std::endl;
+    small.push_back(std::string(600, 'd'));
+    TEST_ASSERT(small.memory_usage() == 1000 && small.size() == 1000, "存储不超过容量上限");
+    TEST_ASSERT(small.at(0) == 'b' && small.at(999) == 'd', "达到上限后覆盖最旧元素");
+
+    // 存储恰好写满时（起止物理位置相同）查找整个范围
+    CircularString full(256);
+    full.push_back(std::string(255, 'e') + "\r");
+    TEST_ASSERT(full.find(0, full.size(), '\r') == 255, "存储写满时仍能查找整个范围");
+    return true;
+}
+
+// 测试批量写入：与逐字节追加、超过容量时丢弃最旧字节的参考模型比较
+bool test_bulk_push_back() {
+    std::cout << "\n[批量写入测试]" << std::endl;
+
+    // 确定性的伪随机数（线性同余），每次运行得到相同的操作序列
+    unsigned int seed = 12345;
+    auto next = [&seed](unsigned int bound) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) % bound;
+    };
+
+    const size_t CAPACITY = 1000;
+    CircularString cs(CAPACITY, 64);
+    std::string model;
+    bool matches = true;
+    for (int round = 0; round < 2000 && matches; ++round) {
+        // 长度覆盖0、小于剩余空间、跨过存储末尾、超过整个容量几种情况
+        size_t length = next(4) == 0 ? next(CAPACITY * 2) : next(200);
+        std::string data(length, '\0');
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = static_cast<char>('a' + next(26));
+        }
+        cs.push_back(data.data(), data.size());
+        model += data;
+        if (model.size() > CAPACITY) {
+            model.erase(0, model.size() - CAPACITY);
+        }
+
+        // 随机删除前缀，让头指针停在不同的物理位置
+        if (!model.empty() && next(3) == 0) {
+            size_t k = next(static_cast<unsigned int>(model.size()));
+            cs.erase_up_to(k);
+            model.erase(0, k + 1);
+        }
+        matches = cs.size() == model.size() &&
+                  (model.empty() || cs.substring(0, model.size() - 1) == model);
+    }
+    TEST_ASSERT(matches, "2000轮随机写入和删除后内容与参考模型一致");
+    TEST_ASSERT(cs.memory_usage() == CAPACITY, "存储增长到容量上限");
+
+    // 一次写入超过容量的数据，只保留最后CAPACITY个字节
+    std::cout << "- 测试单次写入超过容量" << std::endl;
+    CircularString wrap(100);
+    wrap.push_back(std::string(30, 'x'));
+    wrap.erase_up_to(9);
+    std::string big;
+    for (int i = 0; i < 250; ++i) {
+        big += static_cast<char>('0' + i % 10);
+    }
+    wrap.push_back(big);
+    TEST_ASSERT(wrap.size() == 100, "大小等于容量");
+    TEST_ASSERT(wrap.substring(0, 99) == big.substr(150), "只保留最后100个字节");
+    wrap.push_back("\r\n");
+    TEST_ASSERT(wrap.substring(98, 99) == "\r\n" && wrap.at(0) == big[152], "之后的写入继续覆盖最旧元素");
+    return true;
+}
+
+// 测试镜像存储
+bool test_mirrored_storage() {
+    std::cout << "\n[镜像存储测试]" << std::endl;
+
+    // 容量是页大小的倍数：存储按页取整，跨过存储末尾的范围也是连续的
+    const size_t CAPACITY = 64 * 1024;
+    CircularString cs(CAPACITY, 256, true);
+    cs.push_back("a1 LOGIN user pass\r\n");
+#if defined(__linux__)
+    TEST_ASSERT(cs.is_mirrored(), "Linux上使用镜像存储");
+    TEST_ASSERT(cs.memory_usage() % 4096 == 0, "存储大小按页取整");
+#endif
+
+    std::string model;
+    for (int i = 0; i < 300; ++i) {
+        std::string line = "* " + std::to_string(i) + " FETCH (FLAGS (\\Seen))\r\n";
+        cs.push_back(line);
+        model += line;
+        if (model.size() > 2000) {
+            cs.erase_up_to(model.size() - 1001);
+            model.erase(0, model.size() - 1000);
+        }
+    }
+    cs.push_back(std::string(CAPACITY, 'x'));
+    cs.erase_up_to(CAPACITY - 101);
+    model = std::string(100, 'x');
+    std::string tail(CAPACITY / 2 + 7, 'y');
+    tail += "\r\n";
+    cs.push_back(tail);
+    model += tail;
+    if (model.size() > CAPACITY) {
+        model.erase(0, model.size() - CAPACITY);
+    }
+    TEST_ASSERT(cs.size() == model.size() && cs.substring(0, model.size() - 1) == model, "写入和删除后内容正确");
+    if (cs.is_mirrored()) {
+        const char* range = cs.contiguous(0, cs.size() - 1);
+        TEST_ASSERT(range != nullptr && std::string(range, cs.size()) == model, "整个范围是一段连续内存");
+    }
+    TEST_ASSERT(cs.find(0, cs.size(), '\r') == cs.size() - 2, "镜像存储中查找结果正确");
+
+    // 存储增长时从镜像存储换到更大的镜像存储，复制后内容不变
+    CircularString copy(cs);
+    TEST_ASSERT(copy.size() == cs.size() && copy.substring(0, copy.size() - 1) == model, "复制后内容一致");
+    copy.grow_capacity(4 * CAPACITY);
+    copy.push_back(std::string(CAPACITY, 'z'));
+    TEST_ASSERT(copy.size() == model.size() + CAPACITY, "增长后不覆盖旧数据");
+    TEST_ASSERT(copy.substring(0, model.size() - 1) == model, "增长后旧数据保持不变");
+    CircularString moved(std::move(copy));
+    TEST_ASSERT(moved.at(moved.size() - 1) == 'z', "移动后内容不变");
+
+    // 容量不是页大小的倍数：退回堆存储，跨过存储末尾的范围不是连续的
+    std::cout << "- 测试退回堆存储" << std::endl;
+    CircularString fallback(1000, 1000, true);
+    fallback.push_back(std::string(900, 'a'));
+    fallback.erase_up_to(799);
+    fallback.push_back(std::string(200, 'b'));
+    TEST_ASSERT(!fallback.is_mirrored(), "容量不是页大小的倍数时使用堆存储");
+    TEST_ASSERT(fallback.contiguous(0, 99) != nullptr, "不跨过存储末尾的范围是连续的");
+    TEST_ASSERT(fallback.contiguous(0, fallback.size() - 1) == nullptr, "跨过存储末尾的范围不是连续的");
+    TEST_ASSERT(fallback.substring(99, 100) == "ab", "跨过存储末尾的子字符串正确");
+    return true;
+}
+
+// 测试内存段和读取器
+bool test_segments() {
+    std::cout << "\n[内存段测试]" << std::endl;
+
+    // 头指针移动到存储中间后写入，让数据跨过存储末尾
+    CircularString cs(100, 100);
+    cs.push_back(std::string(80, '-'));
+    cs.erase_up_to(69);
+    cs.push_back("0123456789abcdefghijklmnopqrstuvwxyz");
+    const std::string expected = std::string(10, '-') + "0123456789abcdefghijklmnopqrstuvwxyz";
+    TEST_ASSERT(cs.size() == expected.size(), "大小应为46");
+
+    CircularString::Segment parts[2];
+    size_t count = cs.segments(0, cs.size() - 1, parts);
+    TEST_ASSERT(count == 2, "跨过存储末尾的范围分为两段");
+    TEST_ASSERT(parts[0].length == 30 && parts[1].length == 16, "两段的长度分别为30和16");
+    std::string joined = std::string(parts[0].data, parts[0].length) + std::string(parts[1].data, parts[1].length);
+    TEST_ASSERT(joined == expected, "两段按逻辑顺序拼接得到完整数据");
+    count = cs.segments(10, 19, parts);
+    TEST_ASSERT(count == 1 && std::string(parts[0].data, parts[0].length) == "0123456789", "不跨过末尾的范围只有一段");
+
+    std::string out = "prefix:";
+    cs.append_to(out, 25, 40);
+    TEST_ASSERT(out == "prefix:" + expected.substr(25, 16), "append_to追加跨过末尾的范围");
+
+    // 逐字节和逐段读取
+    CircularString::Reader reader(cs, 5, cs.size() - 1);
+    TEST_ASSERT(reader.remaining() == cs.size() - 5, "读取器的剩余字节数");
+    std::string bytes;
+    char c = 0;
+    while (reader.next(c)) {
+        bytes.push_back(c);
+    }
+    TEST_ASSERT(bytes == expected.substr(5) && reader.remaining() == 0, "逐字节读取跨过两段");
+
+    CircularString::Reader segmentReader(cs, 0, cs.size() - 1);
+    c = 0;
+    TEST_ASSERT(segmentReader.next(c) && c == '-', "逐段读取前先读取一个字节");
+    std::string rest;
+    CircularString::Segment segment;
+    size_t segmentCount = 0;
+    while (segmentReader.next_segment(segment)) {
+        rest.append(segment.data, segment.length);
+        ++segmentCount;
+    }
+    TEST_ASSERT(rest == expected.substr(1) && segmentCount == 2, "逐字节读取后逐段读取剩余部分");
+
+    try {
+        cs.segments(10, cs.size(), parts);
+        TEST_ASSERT(false, "越界范围应该抛出异常");
+    } catch (const std::out_of_range&) {
+        std::cout << "  捕获到预期异常" << std::endl;
+    }
+    return true;
+}
+
+// 测试查找回车换行
+bool test_find_crlf() {
+    std::cout << "\n[find_crlf测试]" << std::endl;
+
+    CircularString cs(1000);
+    TEST_ASSERT(cs.find_crlf() == CircularString::npos, "空缓冲区返回npos");
+    cs.push_back("a1 NOOP");
+    TEST_ASSERT(cs.find_crlf() == CircularString::npos, "没有换行符时返回npos");
+    cs.push_back("\r");
+    TEST_ASSERT(cs.find_crlf() == CircularString::npos, "结尾是\\r时返回npos，不抛出异常");
+    cs.push_back("\n");
+    TEST_ASSERT(cs.find_crlf() == 7, "找到行尾");
+    TEST_ASSERT(cs.find_crlf(8) == CircularString::npos, "从行尾之后查找返回npos");
+    TEST_ASSERT(cs.find_crlf(100) == CircularString::npos, "起始索引超出范围时返回npos");
+
+    // 单独的\r和\n不是行尾；长行让SIMD查找跨过多个数据块
+    std::string line = "* 1 FETCH (BODY[TEXT] \"a\rb\nc\")" + std::string(100, 'x') + "\r\n";
+    cs.push_back(line);
+    TEST_ASSERT(cs.find_crlf(9) == 9 + line.size() - 2, "跳过单独的\\r和\\n");
+
+    // 回车换行在各个位置跨过存储末尾（堆存储）
+    std::cout << "- 测试跨过存储末尾" << std::endl;
+    bool allFound = true;
+    for (size_t k = 0; k < 100; ++k) {
+        // 头指针在物理位置64，\r落在物理位置64 + k（超过127时回绕到存储开头）
+        CircularString ring(128, 128);
+        ring.push_back(std::string(64, '-'));
+        ring.erase_up_to(63);
+        ring.push_back(std::string(k, 'y') + "\r\n" + std::string(20, 'z'));
+        allFound &= ring.find_crlf() == k;
+        allFound &= ring.find_crlf(k + 1) == CircularString::npos;
+    }
+    TEST_ASSERT(allFound, "回车换行在存储末尾之前、跨过末尾和回绕之后都能找到");
+
+    // 镜像存储中跨过存储末尾
+    CircularString mirrored(4096, 4096, true);
+    mirrored.push_back(std::string(4090, '-'));
+    mirrored.erase_up_to(4089);
+    mirrored.push_back(std::string(5, 'h') + "\r\n" + std::string(20, 'i'));
+    TEST_ASSERT(mirrored.find_crlf() == 5, "镜像存储中跨过末尾时能找到");
+    return true;
+}
+
+// 测试预编译的子字符串查找器
+bool test_substring_searcher() {
+    std::cout << "\n[预编译查找器测试]" << std::endl;
+
+    const std::string boundary = "--=_Part_1234_5678.1697500000000";
+    SubstringSearcher searcher(boundary);
+    std::string text = std::string(100, 'x') + boundary + "\r\n" + std::string(50, 'y') + boundary + "--\r\n";
+    TEST_ASSERT(searcher.find(text.data(), text.size()) == 100, "在连续内存中找到第一次出现");
+    TEST_ASSERT(searcher.find(text.data(), text.size(), 101) == 100 + boundary.size() + 52, "从指定偏移开始查找");
+    TEST_ASSERT(searcher.find(text.data(), 120) == SubstringSearcher::npos, "数据不完整时返回npos");
+
+    SubstringSearcher overlapping("aa");
+    TEST_ASSERT(overlapping.find("baaa", 4, 2) == 2, "出现位置可以重叠");
+
+    try {
+        SubstringSearcher empty("");
+        TEST_ASSERT(false, "空字符串应该抛出异常");
+    } catch (const std::invalid_argument& e) {
+        std::cout << "  捕获到预期异常: " << e.what() << std::endl;
+    }
+
+    // 目标字符串在各个位置跨过存储末尾，同一个查找器用于所有缓冲区
+    std::cout << "- 测试跨过存储末尾" << std::endl;
+    bool allFound = true;
+    for (size_t k = 0; k < 120; ++k) {
+        CircularString ring(256, 256);
+        ring.push_back(std::string(160, '-'));
+        ring.erase_up_to(159);
+        ring.push_back(std::string(k, 'z') + boundary + std::string(30, 'z') + boundary);
+        allFound &= ring.search(searcher) == k;
+        allFound &= ring.find_nth(searcher, 2) == k + boundary.size() + 30;
+        allFound &= ring.search(searcher, k + boundary.size() + 31) == CircularString::npos;
+    }
+    TEST_ASSERT(allFound, "目标字符串在存储末尾之前、跨过末尾和回绕之后都能找到");
+
+    CircularString cs(1000);
+    cs.push_back("* 1 FETCH (BODY[] {12}\r\nHello World!)\r\n* 2 FETCH (BODY[] {0}\r\n)\r\n");
+    SubstringSearcher terminator(")\r\n");
+    TEST_ASSERT(cs.find_nth(terminator, 2) == cs.size() - 3, "find_nth使用预编译的查找器");
+    TEST_ASSERT(cs.find_nth(")\r\n", 1) == cs.find_nth(terminator, 1), "两种find_nth结果相同");
+    try {
+        cs.find_nth(terminator, 3);
+        TEST_ASSERT(false, "应该抛出异常");
+    } catch (const std::out_of_range& e) {
+        std::cout << "  捕获到预期异常: " << e.what() << std::endl;
+    }
+    return true;
+}
+
 // 运行所有测试
 void run_all_tests() {
     struct {
@@ -332,7 +655,13 @@ void run_all_tests() {
         {"substring测试", test_substring},
         {"erase_up_to测试", test_erase_up_to},
         {"环形逻辑测试", test_circular_logic},
-        {"大规模压力测试", test_large_scale}
+        {"大规模压力测试", test_large_scale},
+        {"按需增长测试", test_growth},
+        {"批量写入测试", test_bulk_push_back},
+        {"镜像存储测试", test_mirrored_storage},
+        {"内存段测试", test_segments},
+        {"find_crlf测试", test_find_crlf},
+        {"预编译查找器测试", test_substring_searcher}
     };
     
     int passed = 0;
@@ -0,0 +1,498 @@
+/**
+ * @file test_circular_string_performance.cpp
+ * @brief 环形字符串写入与查找性能对比测试
+ *
+ * 本测试文件对比CircularString::push_back()的批量复制实现与原先逐字节追加的实现在不同数据长度和
+ * 回绕位置上的写入吞吐量。原实现对每个字节计算一次物理位置（取模）并判断是否已满，
+ * 这里在相同的存储布局上重新实现它作为对照。
+ * 同时对比查找行尾的方式：原先解析器用find()找'\r'再用at()检查下一个字节，
+ * 现在用find_crlf()按内存段SIMD查找"\r\n"；以及find_nth()原先每次调用都用unordered_map建立坏字符表、
+ * 逐字节取模比较的实现与预编译查找器(SubstringSearcher)的实现。
+ *
+ * 主要功能：
+ * 1. 正确性测试 - 两种写入实现在所有场景下写入后的内容相同，各种CRLF查找实现的结果相同
+ * 2. 吞吐量测试 - 数据长度为64B、1460B（一个TCP分段）、64KB和1MB，
+ *    写入不跨过存储末尾、在中间跨过末尾和只有1个字节在末尾三种回绕位置，输出每秒写入的MB数
+ * 3. 行尾查找测试 - 在长FETCH响应行和邮件头部块（很多短行）上逐行查找行尾，输出每秒扫描的MB数
+ * 4. 子字符串查找测试 - 在1MB的邮件正文中查找MIME边界和literal结尾，输出每秒扫描的MB数
+ *
+ * 用法: test_circular_string_performance [每个场景写入的总MB数]，默认32
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include "../include/tools/CircularString.h"
+#include "../include/tools/crlf_scan.h"
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while (0)
+
+// 原先的逐字节写入实现（只用于比较），存储已分配到容量上限
+class ByteRing {
+public:
+    explicit ByteRing(size_t capacity) : buffer(capacity), head(0), count(0) {}
+
+    void push_back(const char* data, size_t length) {
+        const size_t storage = buffer.size();
+        for (size_t i = 0; i < length; ++i) {
+            size_t insert_pos = (head + count) % storage;
+            if (count < storage) {
+                buffer[insert_pos] = data[i];
+                ++count;
+            } else {
+                buffer[insert_pos] = data[i];
+                head = (head + 1) % storage;
+            }
+        }
+    }
+
+    // 删除前k+1个字节，与CircularString::erase_up_to()相同
+    void erase_up_to(size_t k) {
+        head = (head + k + 1) % buffer.size();
+        count -= k + 1;
+    }
+
+    std::string contents() const {
+        std::string result;
+        for (size_t i = 0; i < count; ++i) {
+            result += buffer[(head + i) % buffer.size()];
+        }
+        return result;
+    }
+
+    size_t size() const { return count; }
+
+    // 原先的find_nth实现（Sunday算法，坏字符表为unordered_map），没有找到时返回npos而不抛出异常
+    size_t find_nth(const std::string& target, size_t n) const {
+        const size_t target_len = target.length();
+        const size_t buffer_len = count;
+        if (target_len > buffer_len) {
+            return CircularString::npos;
+        }
+        std::unordered_map<char, size_t> bad_char_shift;
+        for (size_t i = 0; i < target_len; ++i) {
+            bad_char_shift[target[i]] = target_len - i;
+        }
+        size_t occurrences = 0;
+        size_t current = 0;
+        while (current <= buffer_len - target_len) {
+            size_t j;
+            for (j = 0; j < target_len; ++j) {
+                if (buffer[(head + current + j) % buffer.size()] != target[j]) break;
+            }
+            if (j == target_len) {
+                if (++occurrences == n) {
+                    return current;
+                }
+                current += 1;
+            }
+            else {
+                const size_t next_char_pos = current + target_len;
+                if (next_char_pos >= buffer_len) break;
+                const char next_char = buffer[(head + next_char_pos) % buffer.size()];
+                current += bad_char_shift.count(next_char) ? bad_char_shift[next_char] : target_len + 1;
+            }
+        }
+        return CircularString::npos;
+    }
+
+private:
+    std::vector<char> buffer;
+    size_t head;
+    size_t count;
+};
+
+// 写入场景：存储大小为数据长度的2倍并保持写满，每次写入从上一次写入结束的位置开始，
+// 写入位置每两次循环一次，因此起始位置决定了写入在哪里跨过存储末尾
+struct Scenario {
+    const char* name;
+    size_t (*offset)(size_t length);   // 第一次写入的起始物理位置
+};
+
+size_t alignedOffset(size_t) { return 0; }
+size_t middleOffset(size_t length) { return length / 2; }
+size_t nearEndOffset(size_t length) { return 2 * length - 1; }
+
+const size_t PAYLOADS[] = {64, 1460, 64 * 1024, 1024 * 1024};
+const Scenario SCENARIOS[] = {
+    {"不回绕", alignedOffset},        // 写入总是落在存储前半或后半，不跨过末尾
+    {"中间回绕", middleOffset},       // 每两次写入有一次在中间分成两段
+    {"末尾1字节", nearEndOffset},     // 每两次写入有一次只有1个字节在存储末尾
+};
+
+// 把存储写满，并让下一次写入从offset开始：删除前offset个字节后再写回同样多的字节
+template <typename Ring>
+void prepare(Ring& ring, size_t storage, size_t offset) {
+    std::string fill(storage, 'p');
+    ring.push_back(fill.data(), fill.size());
+    if (offset > 0) {
+        ring.erase_up_to(offset - 1);
+        ring.push_back(fill.data(), offset);
+    }
+}
+
+template <typename Ring>
+double measureMBps(Ring& ring, const std::string& payload, size_t totalBytes) {
+    size_t rounds = totalBytes / payload.size();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        ring.push_back(payload.data(), payload.size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    return static_cast<double>(rounds * payload.size()) / (1024.0 * 1024.0) / seconds;
+}
+
+std::string makePayload(size_t length) {
+    std::string payload(length, '\0');
+    for (size_t i = 0; i < length; ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    return payload;
+}
+
+bool test_correctness() {
+    std::cout << "\n[正确性测试]" << std::endl;
+    const size_t capacity = 5000;
+    for (size_t length : {size_t(1), size_t(64), size_t(1460), size_t(4999), size_t(5000), size_t(12000)}) {
+        for (size_t offset : {size_t(0), size_t(2500), size_t(4990)}) {
+            CircularString cs(capacity, capacity);
+            ByteRing reference(capacity);
+            std::string fill(capacity, 'p');
+            cs.push_back(fill.data(), fill.size());
+            reference.push_back(fill.data(), fill.size());
+            if (offset > 0) {
+                cs.erase_up_to(offset - 1);
+                reference.erase_up_to(offset - 1);
+            }
+            std::string payload = makePayload(length);
+            for (int i = 0; i < 3; ++i) {
+                cs.push_back(payload.data(), payload.size());
+                reference.push_back(payload.data(), payload.size());
+            }
+            TEST_ASSERT(cs.size() == reference.size() && cs.substring(0, cs.size() - 1) == reference.contents(),
+                        "长度 " << length << " 起始位置 " << offset << " 写入后内容一致");
+        }
+    }
+    std::cout << "  两种实现写入后的内容一致" << std::endl;
+    return true;
+}
+
+void benchmark(size_t totalBytes) {
+    std::cout << "\n[吞吐量测试] 存储为数据长度的2倍，每个场景写入 " << totalBytes / (1024 * 1024) << "MB" << std::endl;
+    std::cout << "  " << std::left << std::setw(10) << "数据长度" << std::setw(14) << "写入位置"
+              << std::right << std::setw(14) << "逐字节 MB/s" << std::setw(14) << "批量 MB/s"
+              << std::setw(10) << "加速比" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t length : PAYLOADS) {
+        std::string payload = makePayload(length);
+        for (const Scenario& scenario : SCENARIOS) {
+            size_t storage = 2 * length;
+            size_t offset = scenario.offset(length);
+            ByteRing reference(storage);
+            prepare(reference, storage, offset);
+            CircularString cs(storage, storage);
+            prepare(cs, storage, offset);
+
+            double byteRate = measureMBps(reference, payload, totalBytes);
+            double bulkRate = measureMBps(cs, payload, totalBytes);
+            std::cout << "  " << std::left << std::setw(10) << length << std::setw(14) << scenario.name
+                      << std::right << std::setw(14) << byteRate << std::setw(14) << bulkRate
+                      << std::setw(9) << bulkRate / byteRate << "x" << std::endl;
+        }
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
+const char* crlfKindName(CrlfScanKind kind) {
+    return kind == CrlfScanKind::Avx2 ? "AVX2" : kind == CrlfScanKind::Sse2 ? "SSE2" : "逐字节";
+}
+
+// 各种CRLF查找实现与逐字节查找的结果相同
+bool test_crlf_correctness() {
+    std::cout << "\n[行尾查找正确性测试] 当前使用: " << crlfKindName(active_crlf_scan()) << std::endl;
+    unsigned int seed = 7;
+    auto next = [&seed](unsigned int bound) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) % bound;
+    };
+    for (int round = 0; round < 20000; ++round) {
+        // 很多'\r'和'\n'，让单独的'\r'、单独的'\n'和跨数据块的"\r\n"都出现
+        std::string data(next(160), 'a');
+        for (char& c : data) {
+            unsigned int r = next(16);
+            c = r == 0 ? '\r' : r == 1 ? '\n' : static_cast<char>('a' + r);
+        }
+        size_t expected = scan_crlf(data.data(), data.size(), CrlfScanKind::Scalar);
+        TEST_ASSERT(scan_crlf(data.data(), data.size(), CrlfScanKind::Sse2) == expected &&
+                    scan_crlf(data.data(), data.size(), CrlfScanKind::Avx2) == expected &&
+                    scan_crlf(data.data(), data.size()) == expected,
+                    "长度 " << data.size() << " 的数据查找结果一致");
+    }
+    std::cout << "  各种实现的查找结果一致" << std::endl;
+    return true;
+}
+
+// 长FETCH响应行：BODYSTRUCTURE和大量FLAGS组成的一行，中间没有换行
+std::string makeFetchLines() {
+    std::string data;
+    for (int i = 1; data.size() < 256 * 1024; ++i) {
+        std::string line = "* " + std::to_string(i) + " FETCH (UID " + std::to_string(1000 + i) +
+                           " FLAGS (\\Seen \\Answered $Label1) BODYSTRUCTURE (";
+        while (line.size() < 8192) {
+            line += "(\"TEXT\" \"PLAIN\" (\"CHARSET\" \"UTF-8\") NIL NIL \"BASE64\" 4712 61 NIL NIL NIL NIL)";
+        }
+        data += line + " \"MIXED\"))\r\n";
+    }
+    return data;
+}
+
+// 邮件头部块：很多40到80字节的短行
+std::string makeHeaderLines() {
+    static const char* names[] = {"Received", "From", "To", "Subject", "Date", "Message-ID", "Content-Type"};
+    std::string data;
+    for (int i = 0; data.size() < 256 * 1024; ++i) {
+        std::string line = std::string(names[i % 7]) + ": ";
+        line += std::string(30 + (i * 7) % 40, static_cast<char>('a' + i % 26));
+        data += line + "\r\n";
+    }
+    return data;
+}
+
+// 逐行查找行尾（从上一行行尾之后开始），返回每秒扫描的MB数
+double measureLines(size_t totalBytes, size_t bytes, const std::function<size_t(size_t)>& findLineEnd,
+                    size_t& lines) {
+    size_t rounds = totalBytes / bytes + 1;
+    lines = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        size_t position = 0;
+        size_t end;
+        while ((end = findLineEnd(position)) != CircularString::npos) {
+            position = end + 2;
+            ++lines;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    return static_cast<double>(rounds * bytes) / (1024.0 * 1024.0) / seconds;
+}
+
+void benchmarkCrlf(size_t totalBytes) {
+    std::cout << "\n[行尾查找测试] 每种数据扫描 " << totalBytes / (1024 * 1024) << "MB" << std::endl;
+    std::cout << "  " << std::left << std::setw(28) << "实现" << std::right << std::setw(18) << "长FETCH行 MB/s"
+              << std::setw(18) << "头部块 MB/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    const std::string inputs[2] = {makeFetchLines(), makeHeaderLines()};
+    // 数据放进环形缓冲区时跨过存储末尾，和实际的缓冲区一样需要处理回绕
+    CircularString rings[2] = {CircularString(2 * inputs[0].size(), 2 * inputs[0].size()),
+                               CircularString(2 * inputs[1].size(), 2 * inputs[1].size())};
+    for (int i = 0; i < 2; ++i) {
+        std::string fill(inputs[i].size() * 3 / 2, '-');
+        rings[i].push_back(fill);
+        rings[i].erase_up_to(fill.size() - 1);
+        rings[i].push_back(inputs[i]);
+    }
+
+    size_t expectedLines[2] = {0, 0};
+    size_t lines = 0;
+    double rates[2];
+
+    // 原先的方式：find()找'\r'，at()检查下一个字节
+    for (int i = 0; i < 2; ++i) {
+        CircularString& ring = rings[i];
+        rates[i] = measureLines(totalBytes, inputs[i].size(), [&ring](size_t position) {
+            while (position < ring.size()) {
+                size_t end = ring.find(position, ring.size(), '\r');
+                if (end == CircularString::npos || end + 1 >= ring.size()) {
+                    return CircularString::npos;
+                }
+                if (ring.at(end + 1) == '\n') {
+                    return end;
+                }
+                position = end + 1;
+            }
+            return CircularString::npos;
+        }, expectedLines[i]);
+    }
+    std::cout << "  " << std::left << std::setw(28) << "find('\\r') + at()" << std::right << std::setw(16)
+              << rates[0] << std::setw(16) << rates[1] << std::endl;
+
+    for (int i = 0; i < 2; ++i) {
+        const CircularString& ring = rings[i];
+        rates[i] = measureLines(totalBytes, inputs[i].size(), [&ring](size_t position) {
+            return ring.find_crlf(position);
+        }, lines);
+        if (lines != expectedLines[i]) {
+            std::cerr << "  find_crlf找到的行数不同: " << lines << " != " << expectedLines[i] << std::endl;
+        }
+    }
+    std::cout << "  " << std::left << std::setw(28) << "find_crlf()" << std::right << std::setw(16)
+              << rates[0] << std::setw(16) << rates[1] << std::endl;
+
+    // 各种实现直接扫描连续内存
+    for (CrlfScanKind kind : {CrlfScanKind::Scalar, CrlfScanKind::Sse2, CrlfScanKind::Avx2}) {
+        for (int i = 0; i < 2; ++i) {
+            const std::string& input = inputs[i];
+            rates[i] = measureLines(totalBytes, input.size(), [&input, kind](size_t position) {
+                if (position >= input.size()) {
+                    return CircularString::npos;
+                }
+                size_t offset = scan_crlf(input.data() + position, input.size() - position, kind);
+                return offset == input.size() - position ? CircularString::npos : position + offset;
+            }, lines);
+        }
+        std::cout << "  " << std::left << std::setw(28) << std::string("scan_crlf ") + crlfKindName(kind)
+                  << std::right << std::setw(16) << rates[0] << std::setw(16) << rates[1] << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
+// 1MB的邮件正文：每行76个字符的base64编码，每64KB一个MIME边界，最后是literal结尾
+const std::string MIME_BOUNDARY = "--=_Part_1234_5678.1697500000000";
+const std::string LITERAL_END = ")\r\n";
+
+std::string makeMailBody(size_t& boundaries) {
+    static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string data;
+    boundaries = 0;
+    for (size_t line = 0; data.size() < 1024 * 1024; ++line) {
+        if (line % 840 == 0) {
+            data += MIME_BOUNDARY + "\r\nContent-Transfer-Encoding: base64\r\n\r\n";
+            ++boundaries;
+        }
+        for (size_t i = 0; i < 76; ++i) {
+            data += base64[(line * 31 + i * 7 + i * i) % 64];
+        }
+        data += "\r\n";
+    }
+    data += MIME_BOUNDARY + "--\r\n" + LITERAL_END;
+    ++boundaries;
+    return data;
+}
+
+// 预编译查找器与原实现的结果相同（包括跨过存储末尾和重叠的出现位置）
+bool test_searcher_correctness() {
+    std::cout << "\n[子字符串查找正确性测试]" << std::endl;
+    unsigned int seed = 11;
+    auto next = [&seed](unsigned int bound) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) % bound;
+    };
+    for (int round = 0; round < 2000; ++round) {
+        // 小字母表让目标字符串频繁出现
+        const size_t capacity = 300;
+        CircularString cs(capacity, capacity);
+        ByteRing reference(capacity);
+        size_t offset = next(capacity);
+        std::string fill(capacity, '-');
+        cs.push_back(fill.data(), offset + 1);
+        reference.push_back(fill.data(), offset + 1);
+        cs.erase_up_to(offset);
+        reference.erase_up_to(offset);
+        std::string data(next(capacity) + 1, 'a');
+        for (char& c : data) {
+            c = static_cast<char>('a' + next(3));
+        }
+        cs.push_back(data);
+        reference.push_back(data.data(), data.size());
+
+        std::string target = data.substr(next(static_cast<unsigned int>(data.size())), next(20) + 1);
+        SubstringSearcher searcher(target);
+        for (size_t n = 1; n <= 3; ++n) {
+            size_t expected = reference.find_nth(target, n);
+            size_t actual = CircularString::npos;
+            try {
+                actual = cs.find_nth(searcher, n);
+            } catch (const std::out_of_range&) {
+            }
+            TEST_ASSERT(actual == expected, "目标 " << target << " 第" << n << "次出现的位置一致");
+        }
+    }
+    std::cout << "  两种实现的查找结果一致" << std::endl;
+    return true;
+}
+
+void benchmarkSearch(size_t totalBytes) {
+    std::cout << "\n[子字符串查找测试] 1MB邮件正文（跨过存储末尾），每种目标扫描 " << totalBytes / (1024 * 1024)
+              << "MB" << std::endl;
+    std::cout << "  " << std::left << std::setw(28) << "实现" << std::right << std::setw(18) << "MIME边界 MB/s"
+              << std::setw(20) << "literal结尾 MB/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    size_t boundaries = 0;
+    const std::string body = makeMailBody(boundaries);
+    const size_t storage = 2 * body.size();
+    CircularString cs(storage, storage);
+    ByteRing reference(storage);
+    std::string fill(storage * 3 / 4, '-');
+    cs.push_back(fill);
+    reference.push_back(fill.data(), fill.size());
+    cs.erase_up_to(fill.size() - 1);
+    reference.erase_up_to(fill.size() - 1);
+    cs.push_back(body);
+    reference.push_back(body.data(), body.size());
+
+    // 每次查找最后一次出现的位置，扫描整个正文
+    const std::string targets[2] = {MIME_BOUNDARY, LITERAL_END};
+    const size_t counts[2] = {boundaries, 1};
+    const SubstringSearcher searchers[2] = {SubstringSearcher(MIME_BOUNDARY), SubstringSearcher(LITERAL_END)};
+    const size_t rounds = totalBytes / body.size() + 1;
+    const char* names[3] = {"原find_nth", "find_nth(字符串)", "find_nth(预编译查找器)"};
+    for (int method = 0; method < 3; ++method) {
+        double rates[2];
+        for (int t = 0; t < 2; ++t) {
+            size_t checksum = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t r = 0; r < rounds; ++r) {
+                if (method == 0) {
+                    checksum += reference.find_nth(targets[t], counts[t]);
+                } else if (method == 1) {
+                    checksum += cs.find_nth(targets[t], counts[t]);
+                } else {
+                    checksum += cs.find_nth(searchers[t], counts[t]);
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            rates[t] = static_cast<double>(rounds * body.size()) / (1024.0 * 1024.0) / seconds;
+            if (checksum != rounds * (body.size() - targets[t].size() - (t == 0 ? 4 + LITERAL_END.size() : 0))) {
+                std::cerr << "  " << names[method] << "的查找结果不正确" << std::endl;
+            }
+        }
+        std::cout << "  " << std::left << std::setw(28) << names[method] << std::right << std::setw(16) << rates[0]
+                  << std::setw(18) << rates[1] << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "======= 环形字符串写入与查找性能对比测试 =======" << std::endl;
+
+    size_t totalMB = 32;
+    if (argc > 1) {
+        totalMB = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+
+    if (!test_correctness() || !test_crlf_correctness() || !test_searcher_correctness()) {
+        std::cerr << "CircularString正确性测试失败" << std::endl;
+        return 1;
+    }
+
+    benchmark(totalMB * 1024 * 1024);
+    benchmarkCrlf(totalMB * 1024 * 1024);
+    benchmarkSearch(totalMB * 1024 * 1024);
+
+    std::cout << "\n======= 测试完成 =======" << std::endl;
+    return 0;
+}
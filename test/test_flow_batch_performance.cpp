@@ -0,0 +1,206 @@
+/**
+ * @file test_flow_batch_performance.cpp
+ * @brief 批量处理数据包性能测试
+ *
+ * 本测试文件验证HashFlowTable::processBatch()与逐个调用processPacket()的处理结果一致，
+ * 并在大流表上对比不同批大小的吞吐量。
+ *
+ * 主要功能：
+ * 1. 正确性测试 - 双向数据包、LOGOUT删除流和重新建流混在同一批中，批量处理与逐个处理的结果相同
+ * 2. 批量性能测试 - 在预先建立的流表上以随机顺序处理数据包，批大小分别为1、16、64、256
+ *
+ * 用法: test_flow_batch_performance [流数量]，默认1000000
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 生成一个客户端数据包
+InputPacket makeC2SPacket(size_t i, const std::string& payload) {
+    InputPacket packet;
+    packet.type = "C2S";
+    packet.fourTuple = makeTuple(i);
+    packet.payload = payload;
+    return packet;
+}
+
+// 生成一个服务器数据包（四元组为数据包自身方向）
+InputPacket makeS2CPacket(size_t i, const std::string& payload) {
+    InputPacket packet;
+    packet.type = "S2C";
+    packet.fourTuple = makeTuple(i).reversed();
+    packet.payload = payload;
+    return packet;
+}
+
+// 按客户端端口和地址汇总每个流的缓冲区占用
+std::map<uint64_t, size_t> snapshot(HashFlowTable& flowTable) {
+    std::map<uint64_t, size_t> result;
+    for (Flow* flow : flowTable.getAllFlows()) {
+        const FourTuple& tuple = flow->getC2STuple();
+        uint64_t key = (static_cast<uint64_t>(tuple.srcIPv4) << 32) | static_cast<uint32_t>(tuple.sourcePort);
+        result[key] = flow->getBufferBytes();
+    }
+    return result;
+}
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// 批量处理与逐个处理结果一致
+bool test_correctness() {
+    std::cout << "\n[批量处理正确性测试]" << std::endl;
+    std::mt19937_64 rng(7);
+    std::vector<InputPacket> packets;
+    for (size_t n = 0; n < 5000; n++) {
+        size_t flowId = rng() % 300;
+        switch (rng() % 8) {
+            case 0:
+                packets.push_back(makeS2CPacket(flowId, "* OK ready\r\n"));
+                break;
+            case 1:
+                // 同一批中删除流，后续数据包会重新建流
+                packets.push_back(makeC2SPacket(flowId, "a9 LOGOUT\r\n"));
+                break;
+            default:
+                packets.push_back(makeC2SPacket(flowId, "a1 NOOP\r\n"));
+                break;
+        }
+    }
+
+    // 解析器的诊断信息同时写到std::cout和std::cerr
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t sequentialOk = 0;
+    size_t batchedOk = 0;
+    bool sameFlows, sameEvicted, sameBytes, sameSnapshot, emptyBatch;
+    {
+        HashFlowTable sequential;
+        sequential.setBufferSizes(4096, 4096);
+        sequential.setMaxFlows(200);
+        for (const InputPacket& packet : packets) {
+            sequentialOk += sequential.processPacket(packet) ? 1 : 0;
+        }
+
+        HashFlowTable batched;
+        batched.setBufferSizes(4096, 4096);
+        batched.setMaxFlows(200);
+        for (size_t base = 0; base < packets.size(); base += 97) {
+            size_t count = packets.size() - base < 97 ? packets.size() - base : 97;
+            batchedOk += batched.processBatch(&packets[base], count);
+        }
+
+        sameFlows = sequential.getTotalFlows() == batched.getTotalFlows();
+        sameEvicted = sequential.getEvictedFlows() == batched.getEvictedFlows();
+        sameBytes = sequential.getBufferBytes() == batched.getBufferBytes();
+        sameSnapshot = snapshot(sequential) == snapshot(batched);
+        emptyBatch = batched.processBatch(static_cast<const InputPacket*>(nullptr), 0) == 0;
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(sequentialOk == batchedOk && batchedOk == packets.size(), "所有数据包都处理成功");
+    TEST_ASSERT(sameFlows, "流数量相同");
+    TEST_ASSERT(sameEvicted, "淘汰数量相同");
+    TEST_ASSERT(sameBytes, "缓冲区总占用相同");
+    TEST_ASSERT(sameSnapshot, "每个流的缓冲区占用相同");
+    TEST_ASSERT(emptyBatch, "空批次不处理任何数据包");
+    return true;
+}
+
+// 对比不同批大小的吞吐量
+void benchmark(size_t flowCount) {
+    std::cout << "\n[批量处理性能测试] 流数量: " << flowCount << std::endl;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    // 流表在输出重定向期间析构，避免逐个打印清理信息
+    HashFlowTable* table = new HashFlowTable();
+    HashFlowTable& flowTable = *table;
+    flowTable.setBufferSizes(4096, 4096);
+    for (size_t i = 0; i < flowCount; i++) {
+        flowTable.getOrCreateFlow(makeTuple(i));
+    }
+
+    // 随机命中已存在的流，数据不含换行符，解析只做一次查找
+    std::mt19937_64 rng(12345);
+    const size_t packetCount = flowCount < 1000000 ? flowCount : 1000000;
+    std::vector<InputPacket> packets(packetCount);
+    for (size_t i = 0; i < packetCount; i++) {
+        packets[i] = makeC2SPacket(rng() % flowCount, "x");
+    }
+
+    // 预热一遍，使被访问的流都已分配缓冲区存储，各批大小的测量条件相同
+    flowTable.processBatch(packets.data(), packets.size());
+
+    const size_t batchSizes[] = {1, 16, 64, 256};
+    double results[4];
+    for (int b = 0; b < 4; b++) {
+        size_t batchSize = batchSizes[b];
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t base = 0; base < packetCount; base += batchSize) {
+            size_t count = packetCount - base < batchSize ? packetCount - base : batchSize;
+            flowTable.processBatch(&packets[base], count);
+        }
+        results[b] = elapsedMs(start);
+    }
+    size_t totalFlows = flowTable.getTotalFlows();
+    delete table;
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    for (int b = 0; b < 4; b++) {
+        std::cout << "  批大小 " << std::left << std::setw(6) << batchSizes[b]
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2) << results[b] << " ms  "
+                  << std::setw(8) << std::setprecision(2) << (packetCount / results[b] / 1000.0) << " Mpps" << std::endl;
+    }
+    std::cout << "  流数量: " << totalFlows << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "======= 批量处理数据包性能测试 =======" << std::endl;
+
+    size_t flowCount = 1000000;
+    if (argc > 1) {
+        flowCount = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+
+    if (!test_correctness()) {
+        std::cerr << "\n批量处理正确性测试失败" << std::endl;
+        return 1;
+    }
+
+    benchmark(flowCount);
+
+    std::cout << "\n======= 测试完成 =======" << std::endl;
+    return 0;
+}
@@ -0,0 +1,370 @@
+/**
+ * @file test_flow_checkpoint.cpp
+ * @brief 流表检查点测试
+ *
+ * 本测试文件验证HashFlowTable::saveCheckpoint()/restoreCheckpoint()：
+ * 插件重启前保存流表，重启后恢复，进行中的IMAP会话可以继续解析。
+ *
+ * 主要测试功能：
+ * 1. 往返测试 - IPv4和IPv6流、缓冲区中未解析完的命令和响应、容量上限在恢复后相同，
+ *    后续数据包到达时能解析出完整的命令
+ * 2. 空闲时间测试 - 恢复后按空闲时间换算最后活动时间，超时判断与保存时一致
+ * 3. 无效文件测试 - 文件不存在、被截断或魔数错误时不恢复任何流
+ * 4. 已有连接测试 - 恢复时已存在的连接保持当前状态
+ * 5. literal状态测试 - 在literal中间保存的流恢复后继续跳过literal内容，正文中形如声明的文本不使缓冲区扩容
+ * 6. 规模测试 - 保存和恢复大量流的耗时
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 生成IPv6四元组（客户端到服务器方向）
+FourTuple makeIPv6Tuple() {
+    FourTuple tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    tuple.srcIPvN = 6;
+    tuple.dstIPvN = 6;
+    for (int i = 0; i < 16; i++) {
+        tuple.srcIPv6[i] = static_cast<unsigned char>(0x20 + i);
+        tuple.dstIPv6[i] = static_cast<unsigned char>(0x80 + i);
+    }
+    tuple.sourcePort = 50000;
+    tuple.destPort = 993;
+    return tuple;
+}
+
+// 生成指向payload的数据包视图
+PacketView makeView(const FourTuple& c2sTuple, PacketDirection direction, const std::string& payload, int64_t timestamp = 0) {
+    PacketView view;
+    view.data = payload.data();
+    view.length = payload.size();
+    view.direction = direction;
+    view.fourTuple = direction == PacketDirection::C2S ? c2sTuple : c2sTuple.reversed();
+    view.timestamp = timestamp;
+    return view;
+}
+
+// 测试用的检查点文件路径
+std::string checkpointFile(const std::string& name) {
+    return "/tmp/test_flow_checkpoint_" + std::to_string(getpid()) + "_" + name;
+}
+
+// 保存后恢复，缓冲区和容量相同，后续数据包继续解析
+bool test_round_trip() {
+    std::cout << "\n[往返测试]" << std::endl;
+    const std::string path = checkpointFile("round_trip");
+    const FourTuple ipv4 = makeTuple(1);
+    const FourTuple ipv6 = makeIPv6Tuple();
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    bool saved, restored;
+    size_t restoredFlows = 0;
+    size_t totalFlows = 0;
+    size_t c2sBuffered = 0, s2cBuffered = 0, c2sCapacity = 0, s2cCapacity = 0, v6Buffered = 0;
+    uint64_t messagesAfterTail = 0;
+    std::ostringstream output;
+    {
+        HashFlowTable original;
+        original.setBufferSizes(8192, 16384);
+        original.processPacket(makeView(ipv4, PacketDirection::C2S, "a1 LOGIN user pass\r\na2 SEL"));
+        original.processPacket(makeView(ipv4, PacketDirection::S2C, "* 1 FETCH (FLAGS (\\Se"));
+        original.processPacket(makeView(ipv6, PacketDirection::C2S, "b1 CAPABI"));
+        saved = original.saveCheckpoint(path);
+
+        HashFlowTable resumed;
+        restored = resumed.restoreCheckpoint(path, restoredFlows);
+        totalFlows = resumed.getTotalFlows();
+        Flow* flow = resumed.getOrCreateFlow(ipv4, true);
+        c2sBuffered = flow->getBufferedBytes(PacketDirection::C2S);
+        s2cBuffered = flow->getBufferedBytes(PacketDirection::S2C);
+        c2sCapacity = flow->getBufferCapacity(PacketDirection::C2S);
+        s2cCapacity = flow->getBufferCapacity(PacketDirection::S2C);
+        v6Buffered = resumed.getOrCreateFlow(ipv6.reversed(), false)->getBufferedBytes(PacketDirection::C2S);
+
+        // 命令的后半部分在重启后到达
+        uint64_t before = resumed.getStats().messagesParsed;
+        resumed.processPacket(makeView(ipv4, PacketDirection::C2S, "ECT INBOX\r\n"));
+        resumed.processPacket(makeView(ipv6, PacketDirection::C2S, "LITY\r\n"));
+        messagesAfterTail = resumed.getStats().messagesParsed - before;
+        resumed.outputResults(output);
+    }
+    std::remove(path.c_str());
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(saved, "保存检查点");
+    TEST_ASSERT(restored && restoredFlows == 2 && totalFlows == 2, "恢复两个流");
+    TEST_ASSERT(c2sBuffered == std::string("a2 SEL").size(), "C2S缓冲区中未解析完的命令被恢复");
+    TEST_ASSERT(s2cBuffered == std::string("* 1 FETCH (FLAGS (\\Se").size(), "S2C缓冲区中未解析完的响应被恢复");
+    TEST_ASSERT(c2sCapacity == 8192 && s2cCapacity == 16384, "容量上限被恢复");
+    TEST_ASSERT(v6Buffered == std::string("b1 CAPABI").size(), "IPv6流可以用反方向的四元组找到");
+    TEST_ASSERT(messagesAfterTail == 2, "后续数据包与恢复的数据拼成完整的命令");
+    TEST_ASSERT(output.str().find("SELECT") != std::string::npos &&
+                output.str().find("CAPABILITY") != std::string::npos, "解析出跨越重启的命令");
+    return true;
+}
+
+// 恢复后超时判断与保存时一致
+bool test_idle_time() {
+    std::cout << "\n[空闲时间测试]" << std::endl;
+    const std::string path = checkpointFile("idle_time");
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    size_t restoredFlows = 0;
+    size_t remaining = 0;
+    bool recentSurvived = false;
+    {
+        HashFlowTable original;
+        original.setTimeSource(TimeSourceMode::Packet);
+        original.processPacket(makeView(makeTuple(1), PacketDirection::C2S, "a1 NOOP\r\n", 10000));
+        original.processPacket(makeView(makeTuple(2), PacketDirection::C2S, "a1 NOOP\r\n", 15000));
+        original.processPacket(makeView(makeTuple(3), PacketDirection::C2S, "a1 NOOP\r\n", 15500));
+        original.saveCheckpoint(path);
+
+        // 新流表的时钟与原流表无关：空闲时间分别为5500、500、0毫秒
+        HashFlowTable resumed;
+        resumed.setTimeSource(TimeSourceMode::Packet);
+        resumed.setFlowTimeout(2000);
+        resumed.advanceClock(100000);
+        resumed.restoreCheckpoint(path, restoredFlows);
+
+        resumed.advanceClock(101000);
+        resumed.checkAndCleanupTimeoutFlows();
+        remaining = resumed.getTotalFlows();
+        for (Flow* flow : resumed.getAllFlows()) {
+            recentSurvived |= flow->getC2STuple().sourcePort == makeTuple(2).sourcePort;
+        }
+    }
+    std::remove(path.c_str());
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(restoredFlows == 3, "恢复三个流");
+    TEST_ASSERT(remaining == 2 && recentSurvived, "只有空闲时间超过超时时间的流被清理");
+    return true;
+}
+
+// 无效的检查点文件不恢复任何流
+bool test_invalid_files() {
+    std::cout << "\n[无效文件测试]" << std::endl;
+    const std::string path = checkpointFile("invalid");
+    const std::string truncatedPath = checkpointFile("truncated");
+    const std::string badMagicPath = checkpointFile("bad_magic");
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    bool missing, truncated, badMagic;
+    size_t flowsAfter = 0;
+    {
+        HashFlowTable original;
+        for (size_t i = 0; i < 10; i++) {
+            original.processPacket(makeView(makeTuple(i), PacketDirection::C2S, "a1 SELECT INB"));
+        }
+        original.saveCheckpoint(path);
+
+        std::ifstream in(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream(truncatedPath, std::ios::binary).write(content.data(), content.size() - 5);
+        std::string corrupted = content;
+        corrupted[0] = 'X';
+        std::ofstream(badMagicPath, std::ios::binary).write(corrupted.data(), corrupted.size());
+
+        HashFlowTable resumed;
+        size_t restoredFlows = 0;
+        missing = !resumed.restoreCheckpoint(checkpointFile("missing"), restoredFlows) && restoredFlows == 0;
+        truncated = !resumed.restoreCheckpoint(truncatedPath, restoredFlows) && restoredFlows == 0;
+        badMagic = !resumed.restoreCheckpoint(badMagicPath, restoredFlows) && restoredFlows == 0;
+        flowsAfter = resumed.getTotalFlows();
+    }
+    std::remove(path.c_str());
+    std::remove(truncatedPath.c_str());
+    std::remove(badMagicPath.c_str());
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(missing, "文件不存在时返回false");
+    TEST_ASSERT(truncated, "文件被截断时返回false");
+    TEST_ASSERT(badMagic, "魔数错误时返回false");
+    TEST_ASSERT(flowsAfter == 0, "没有恢复任何流");
+    return true;
+}
+
+// 恢复时已存在的连接保持当前状态
+bool test_existing_connection() {
+    std::cout << "\n[已有连接测试]" << std::endl;
+    const std::string path = checkpointFile("existing");
+    const FourTuple tuple = makeTuple(7);
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    size_t restoredFlows = 0;
+    size_t buffered = 0;
+    size_t totalFlows = 0;
+    {
+        HashFlowTable original;
+        original.processPacket(makeView(tuple, PacketDirection::C2S, "a1 OLD STATE"));
+        original.processPacket(makeView(makeTuple(8), PacketDirection::C2S, "a1 NOOP"));
+        original.saveCheckpoint(path);
+
+        HashFlowTable resumed;
+        resumed.processPacket(makeView(tuple, PacketDirection::C2S, "a2 NEW"));
+        resumed.restoreCheckpoint(path, restoredFlows);
+        buffered = resumed.getOrCreateFlow(tuple, true)->getBufferedBytes(PacketDirection::C2S);
+        totalFlows = resumed.getTotalFlows();
+    }
+    std::remove(path.c_str());
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(restoredFlows == 1 && totalFlows == 2, "只恢复不存在的连接");
+    TEST_ASSERT(buffered == std::string("a2 NEW").size(), "已存在的连接保持当前的缓冲区");
+    return true;
+}
+
+// 恢复在literal中间的流，继续跳过literal内容
+bool test_literal_state() {
+    std::cout << "\n[literal状态测试]" << std::endl;
+    const std::string path = checkpointFile("literal");
+    const size_t ceiling = 1024 * 1024;
+    const FourTuple tuple = makeTuple(9);
+    const std::string content = "Subject: test\r\n\r\n{999999999}\r\n";
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t restoredFlows = 0;
+    size_t remainingAfterRestore = 0;
+    size_t tailAfterRestore = 0;
+    size_t s2cCapacity = 0;
+    size_t c2sCapacity = 0;
+    {
+        BufferProfile profile;
+        profile.c2s.maximum = 4096;
+        profile.s2c.maximum = 8192;
+
+        // S2C在FETCH的literal中间，C2S的APPEND声明被拆在两个数据包之间
+        HashFlowTable original;
+        original.setBufferSizingPolicy(std::unique_ptr<BufferSizingPolicy>(new PortBufferSizingPolicy(profile, ceiling)));
+        original.processPacket(makeView(tuple, PacketDirection::S2C,
+                                        "* 1 FETCH (RFC822 {" + std::to_string(content.size()) + "}\r\nSubj"));
+        original.processPacket(makeView(tuple, PacketDirection::C2S, "a1 APPEND INBOX {3"));
+        original.saveCheckpoint(path);
+
+        HashFlowTable resumed;
+        resumed.setBufferSizingPolicy(std::unique_ptr<BufferSizingPolicy>(new PortBufferSizingPolicy(profile, ceiling)));
+        resumed.restoreCheckpoint(path, restoredFlows);
+        Flow* flow = resumed.getOrCreateFlow(tuple, true);
+        remainingAfterRestore = flow->getLiteralTracker(PacketDirection::S2C).remaining();
+        tailAfterRestore = flow->getLiteralTracker(PacketDirection::C2S).pendingTailLength();
+
+        // literal的其余内容在重启后到达
+        resumed.processPacket(makeView(tuple, PacketDirection::S2C, content.substr(4) + ")\r\n"));
+        resumed.processPacket(makeView(tuple, PacketDirection::C2S, "0}\r\n"));
+        s2cCapacity = flow->getBufferCapacity(PacketDirection::S2C);
+        c2sCapacity = flow->getBufferCapacity(PacketDirection::C2S);
+    }
+    std::remove(path.c_str());
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(restoredFlows == 1, "恢复一个流");
+    TEST_ASSERT(remainingAfterRestore == content.size() - 4, "恢复当前literal尚未到达的字节数");
+    TEST_ASSERT(tailAfterRestore == LiteralTracker::TAIL_SIZE, "恢复未结束行保留的最后几个字节");
+    TEST_ASSERT(s2cCapacity < ceiling, "literal内容中形如声明的文本不使缓冲区扩容");
+    TEST_ASSERT(c2sCapacity >= 30 + LITERAL_HEADROOM && c2sCapacity < ceiling, "跨越重启的声明被识别");
+    return true;
+}
+
+// 保存和恢复大量流的耗时
+bool test_scale() {
+    std::cout << "\n[规模测试]" << std::endl;
+    const std::string path = checkpointFile("scale");
+    const size_t flowCount = 100000;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    size_t restoredFlows = 0;
+    size_t totalFlows = 0;
+    double saveMs = 0;
+    double restoreMs = 0;
+    {
+        HashFlowTable* original = new HashFlowTable();
+        original->setBufferSizes(4096, 4096);
+        for (size_t i = 0; i < flowCount; i++) {
+            original->processPacket(makeView(makeTuple(i), PacketDirection::C2S, "a1 FETCH 1:* (FL"));
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        original->saveCheckpoint(path);
+        saveMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        delete original;
+
+        HashFlowTable* resumed = new HashFlowTable();
+        start = std::chrono::high_resolution_clock::now();
+        resumed->restoreCheckpoint(path, restoredFlows);
+        restoreMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        totalFlows = resumed->getTotalFlows();
+        delete resumed;
+    }
+    std::remove(path.c_str());
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    std::cout << "  " << flowCount << " 个流: 保存 " << saveMs << " ms, 恢复 " << restoreMs << " ms" << std::endl;
+    TEST_ASSERT(restoredFlows == flowCount && totalFlows == flowCount, "所有流都被恢复");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 流表检查点测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_round_trip();
+    allPassed &= test_idle_time();
+    allPassed &= test_invalid_files();
+    allPassed &= test_existing_connection();
+    allPassed &= test_literal_state();
+    allPassed &= test_scale();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
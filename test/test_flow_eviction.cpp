@@ -0,0 +1,163 @@
+/**
+ * @file test_flow_eviction.cpp
+ * @brief 流表容量上限与LRU淘汰测试
+ *
+ * 本测试文件验证HashFlowTable在达到最大流数量或缓冲区总字节上限时，
+ * 按最久未活动的顺序淘汰流，并正确统计淘汰数量。
+ *
+ * 主要测试功能：
+ * 1. 最大流数量测试 - 创建超过上限的流，验证只保留最近活动的流
+ * 2. LRU顺序测试 - 被再次访问的流不会被优先淘汰
+ * 3. 内存上限测试 - 缓冲区总字节数始终不超过上限
+ * 4. 突发流量测试 - 模拟大量短连接涌入，验证流数量和内存保持在上限内
+ */
+
+#include <iostream>
+#include <set>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 收集流表中所有流的客户端端口
+std::set<int> collectPorts(HashFlowTable& flowTable) {
+    std::set<int> ports;
+    for (Flow* flow : flowTable.getAllFlows()) {
+        ports.insert(flow->getC2STuple().sourcePort);
+    }
+    return ports;
+}
+
+// 最大流数量
+bool test_max_flows() {
+    std::cout << "\n[最大流数量测试]" << std::endl;
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(64, 64);
+    flowTable.setMaxFlows(100);
+
+    for (size_t i = 0; i < 250; i++) {
+        flowTable.getOrCreateFlow(makeTuple(i));
+    }
+    TEST_ASSERT(flowTable.getTotalFlows() == 100, "流数量应等于上限");
+    TEST_ASSERT(flowTable.getEvictedFlows() == 150, "淘汰数量应为150");
+
+    std::set<int> ports = collectPorts(flowTable);
+    TEST_ASSERT(ports.size() == 100 && *ports.begin() == 1024 + 150, "应只保留最近创建的100个流");
+    TEST_ASSERT(flowTable.getBufferBytes() == 0, "没有收到数据的流不占用缓冲区");
+
+    // 调小上限时立即淘汰
+    flowTable.setMaxFlows(10);
+    TEST_ASSERT(flowTable.getTotalFlows() == 10 && flowTable.getEvictedFlows() == 240, "调小上限后立即淘汰多出的流");
+    return true;
+}
+
+// 被再次访问的流移到链表尾，不会被优先淘汰
+bool test_lru_order() {
+    std::cout << "\n[LRU顺序测试]" << std::endl;
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(64, 64);
+    flowTable.setMaxFlows(3);
+
+    flowTable.getOrCreateFlow(makeTuple(0));
+    flowTable.getOrCreateFlow(makeTuple(1));
+    flowTable.getOrCreateFlow(makeTuple(2));
+    // 再次访问流0，此时最久未活动的是流1
+    flowTable.getOrCreateFlow(makeTuple(0));
+    flowTable.getOrCreateFlow(makeTuple(3));
+
+    std::set<int> ports = collectPorts(flowTable);
+    TEST_ASSERT(ports.count(1024 + 0) == 1, "最近访问过的流0应保留");
+    TEST_ASSERT(ports.count(1024 + 1) == 0, "最久未活动的流1应被淘汰");
+    TEST_ASSERT(flowTable.getEvictedFlows() == 1, "只淘汰一个流");
+    return true;
+}
+
+// 构造一个C2S数据包，负载中没有换行符，解析器会把数据保留在缓冲区中
+InputPacket makeDataPacket(size_t i, size_t bytes) {
+    InputPacket packet;
+    packet.type = "C2S";
+    packet.payload.assign(bytes, 'x');
+    packet.fourTuple = makeTuple(i);
+    return packet;
+}
+
+// 缓冲区总字节上限
+bool test_memory_budget() {
+    std::cout << "\n[内存上限测试]" << std::endl;
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(1024, 1024);
+    flowTable.setMaxBufferBytes(10 * 1024);
+
+    // 每个流的C2S缓冲区写满1024字节
+    for (size_t i = 0; i < 30; i++) {
+        flowTable.processPacket(makeDataPacket(i, 1024));
+    }
+    TEST_ASSERT(flowTable.getBufferBytes() <= 10 * 1024, "缓冲区总量不应超过上限");
+    TEST_ASSERT(flowTable.getTotalFlows() == 10, "上限内最多容纳10个流");
+    TEST_ASSERT(flowTable.getEvictedFlows() == 20, "淘汰数量应为20");
+
+    // 已有的流数据增长时淘汰其他最久未活动的流，正在处理的流保留
+    flowTable.processPacket(makeDataPacket(100, 100));
+    TEST_ASSERT(flowTable.getTotalFlows() == 10 && flowTable.getEvictedFlows() == 21, "新流的数据超出上限时淘汰最旧的流");
+    flowTable.processPacket(makeDataPacket(100, 900));
+    TEST_ASSERT(flowTable.getBufferBytes() <= 10 * 1024, "数据增长后仍在上限内");
+    TEST_ASSERT(collectPorts(flowTable).count(1024 + 100) == 1, "正在处理的流不会被淘汰");
+    return true;
+}
+
+// 大量短连接涌入
+bool test_burst() {
+    std::cout << "\n[突发流量测试]" << std::endl;
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(512, 512);
+    flowTable.setMaxFlows(1000);
+    flowTable.setMaxBufferBytes(256 * 1024);
+
+    size_t peakFlows = 0;
+    size_t peakBytes = 0;
+    for (size_t i = 0; i < 100000; i++) {
+        flowTable.processPacket(makeDataPacket(i, 512));
+        peakFlows = std::max(peakFlows, flowTable.getTotalFlows());
+        peakBytes = std::max(peakBytes, flowTable.getBufferBytes());
+    }
+    TEST_ASSERT(peakFlows <= 512, "流数量峰值受内存上限约束");
+    TEST_ASSERT(peakBytes <= 256 * 1024, "内存峰值不超过上限");
+    TEST_ASSERT(flowTable.getEvictedFlows() == 100000 - flowTable.getTotalFlows(), "淘汰数量与流数量一致");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 流表容量上限与LRU淘汰测试 =======" << std::endl;
+
+    // 屏蔽流表内部的逐流调试输出，断言失败信息仍输出到标准错误
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    bool allPassed = true;
+    allPassed &= test_max_flows();
+    allPassed &= test_lru_order();
+    allPassed &= test_memory_budget();
+    allPassed &= test_burst();
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file test_flow_expiry_stress.cpp
+ * @brief 流批量超时删除压力测试
+ *
+ * 本测试文件验证HashFlowTable删除流的代价为O(1)：
+ * 依次创建N = 125000、250000、500000、1000000个流，让它们全部超时，
+ * 然后调用checkAndCleanupTimeoutFlows()一次性清理，记录每个流的平均删除耗时。
+ *
+ * 如果删除是O(1)的，总耗时随N线性增长，每流平均耗时大致不变；
+ * 旧实现每次删除都要扫描整个流表和时间链表，总耗时随N平方增长。
+ *
+ * 在清理之前，测试还会反复"触碰"一组固定大小的活跃流（相当于这些流持续到达数据包），
+ * 记录每次触碰的平均耗时。活跃流数量固定而流表总规模变化，流位置更新是侵入式链表上的
+ * O(1)摘链/挂链，因此该耗时不应随流表规模增长；旧实现每次都要线性扫描整个时间链表。
+ *
+ * 为避免创建大量流时占用过多内存，测试把每个流的缓冲区容量设为64字节，
+ * 并把流表的调试输出重定向到空缓冲区。
+ *
+ * 用法: test_flow_expiry_stress [最大流数量]，默认1000000
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 单个规模下的测试结果（纳秒/流）
+struct StressResult {
+    double touchNs;    // 每次触碰活跃流的平均耗时
+    double expireNs;   // 每个流的平均超时清理耗时
+};
+
+// 创建count个流，随机触碰一遍后全部超时清理，失败返回false
+bool runStress(size_t count, StressResult& result) {
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(64, 64);
+    flowTable.setFlowTimeout(0);
+    flowTable.setTimingWheel(1, 1000);
+
+    for (size_t i = 0; i < count; i++) {
+        flowTable.getOrCreateFlow(makeTuple(i));
+    }
+    if (flowTable.getTotalFlows() != count) {
+        return false;
+    }
+
+    // 反复触碰固定数量的活跃流，每次都会把流移动到时间链表末尾
+    const size_t activeFlows = std::min<size_t>(4096, count);
+    const size_t rounds = 64;
+    std::vector<FourTuple> tuples(activeFlows);
+    for (size_t i = 0; i < activeFlows; i++) {
+        tuples[i] = makeTuple(i * (count / activeFlows));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const FourTuple& tuple : tuples) {
+            flowTable.getOrCreateFlow(tuple);
+        }
+    }
+    result.touchNs = std::chrono::duration<double, std::nano>(
+        std::chrono::high_resolution_clock::now() - start).count() / (activeFlows * rounds);
+    if (flowTable.getTotalFlows() != count) {
+        return false;
+    }
+
+    // 保证所有流的空闲时间都大于超时时间（流表使用粗粒度单调时钟，精度为一个时钟节拍）
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    start = std::chrono::high_resolution_clock::now();
+    flowTable.checkAndCleanupTimeoutFlows();
+    result.expireNs = std::chrono::duration<double, std::nano>(
+        std::chrono::high_resolution_clock::now() - start).count() / count;
+
+    return flowTable.getTotalFlows() == 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "======= 流批量超时删除压力测试 =======" << std::endl;
+
+    size_t maxFlows = 1000000;
+    if (argc > 1) {
+        maxFlows = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+
+    std::vector<size_t> sizes;
+    for (size_t n = maxFlows / 8; n <= maxFlows && n > 0; n *= 2) {
+        sizes.push_back(n);
+    }
+
+    std::vector<StressResult> results;
+    for (size_t n : sizes) {
+        // 屏蔽流表内部的逐流调试输出
+        NullBuffer nullBuffer;
+        std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+        StressResult result;
+        bool ok = runStress(n, result);
+        std::cout.rdbuf(oldCoutStreamBuf);
+
+        if (!ok) {
+            std::cerr << "错误: " << n << " 个流未能全部创建或清理" << std::endl;
+            return 1;
+        }
+        results.push_back(result);
+        std::cout << "  流数量: " << std::setw(8) << n
+                  << "  触碰每次: " << std::setw(8) << std::fixed << std::setprecision(1) << result.touchNs << " ns"
+                  << "  清理总耗时: " << std::setw(10) << std::setprecision(2) << result.expireNs * n / 1e6 << " ms"
+                  << "  清理每流: " << std::setw(8) << std::setprecision(1) << result.expireNs << " ns" << std::endl;
+    }
+
+    // 线性增长检查：流数量扩大8倍后，每流耗时不应超过最小规模的4倍
+    if (results.size() >= 2) {
+        double touchRatio = results.back().touchNs / results.front().touchNs;
+        double expireRatio = results.back().expireNs / results.front().expireNs;
+        std::cout << "  每流耗时比(最大规模/最小规模): 触碰 " << std::setprecision(2) << touchRatio
+                  << ", 清理 " << expireRatio << std::endl;
+        if (touchRatio > 4.0) {
+            std::cerr << "错误: 流位置更新耗时随流数量超线性增长" << std::endl;
+            return 1;
+        }
+        if (expireRatio > 4.0) {
+            std::cerr << "错误: 删除耗时随流数量超线性增长" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "\n======= 测试完成 =======" << std::endl;
+    return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file test_flow_index_performance.cpp
+ * @brief 流索引性能对比测试
+ *
+ * 本测试文件对比开放寻址流索引(FlowIndex)与原先基于
+ * std::unordered_multimap<int, Flow*>的流映射在插入和查找上的吞吐量。
+ *
+ * 主要功能：
+ * 1. 正确性测试 - 验证FlowIndex的插入、查找、删除与扩容行为
+ * 2. 插入性能测试 - 分别向两种结构插入相同的N个随机四元组
+ * 3. 查找性能测试 - 以随机顺序查找已存在的四元组（命中）和不存在的四元组（未命中）
+ *
+ * 旧实现中每个值是流指针，比较时需要解引用流对象取出四元组，
+ * 这里用单独堆分配的四元组模拟这一次指针追逐。
+ *
+ * 用法: test_flow_index_performance [流数量]，默认200000
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdlib>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/flows/flow_index.h"
+#include "../include/tools/types.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+    } while (0)
+
+// 生成随机四元组（约1/4为IPv6）
+std::vector<FourTuple> generateTuples(size_t count, std::mt19937_64& rng) {
+    std::vector<FourTuple> tuples(count);
+    for (size_t i = 0; i < count; i++) {
+        FourTuple& t = tuples[i];
+        memset(&t, 0, sizeof(t));
+        if (rng() % 4 == 0) {
+            t.srcIPvN = 6;
+            t.dstIPvN = 6;
+            for (int j = 0; j < 16; j++) {
+                t.srcIPv6[j] = static_cast<unsigned char>(rng());
+                t.dstIPv6[j] = static_cast<unsigned char>(rng());
+            }
+        } else {
+            t.srcIPvN = 4;
+            t.dstIPvN = 4;
+            t.srcIPv4 = static_cast<unsigned int>(rng());
+            t.dstIPv4 = static_cast<unsigned int>(rng());
+        }
+        t.sourcePort = 1024 + static_cast<int>(rng() % 64511);
+        t.destPort = (rng() % 2 == 0) ? 143 : 993;
+    }
+    return tuples;
+}
+
+// 用于FlowIndex的伪流指针（索引只保存指针，不解引用）
+Flow* fakeFlow(size_t i) {
+    return reinterpret_cast<Flow*>((i + 1) * 64);
+}
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void printRate(const std::string& name, size_t ops, double ms) {
+    std::cout << "  " << std::left << std::setw(36) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << ms << " ms  "
+              << std::setw(8) << std::setprecision(2) << (ops / ms / 1000.0) << " Mops/s" << std::endl;
+}
+
+// 测试FlowIndex的基本功能
+bool test_correctness() {
+    std::cout << "\n[FlowIndex正确性测试]" << std::endl;
+    std::mt19937_64 rng(42);
+    std::vector<FourTuple> tuples = generateTuples(20000, rng);
+
+    // 从很小的容量开始，覆盖多次扩容
+    FlowIndex index(8);
+    for (size_t i = 0; i < tuples.size(); i++) {
+        index.insert(FlowKey(tuples[i]), HashFlowTable::hashFourTuple(tuples[i]), fakeFlow(i));
+    }
+    TEST_ASSERT(index.size() == tuples.size(), "插入后大小应等于四元组数量");
+
+    for (size_t i = 0; i < tuples.size(); i++) {
+        TEST_ASSERT(index.find(FlowKey(tuples[i]), HashFlowTable::hashFourTuple(tuples[i])) == fakeFlow(i),
+                    "应能找到每个已插入的四元组");
+    }
+
+    // 删除偶数位置的元素
+    for (size_t i = 0; i < tuples.size(); i += 2) {
+        TEST_ASSERT(index.erase(FlowKey(tuples[i]), HashFlowTable::hashFourTuple(tuples[i])), "删除应成功");
+    }
+    TEST_ASSERT(index.size() == tuples.size() / 2, "删除一半后大小应减半");
+    for (size_t i = 0; i < tuples.size(); i++) {
+        Flow* found = index.find(FlowKey(tuples[i]), HashFlowTable::hashFourTuple(tuples[i]));
+        TEST_ASSERT(found == (i % 2 == 0 ? nullptr : fakeFlow(i)), "删除后查找结果应正确");
+    }
+    TEST_ASSERT(!index.erase(FlowKey(tuples[0]), HashFlowTable::hashFourTuple(tuples[0])), "重复删除应失败");
+
+    size_t visited = 0;
+    index.forEach([&visited](Flow*) { visited++; });
+    TEST_ASSERT(visited == index.size(), "遍历的流数量应等于大小");
+
+    std::cout << "  结果: 通过" << std::endl;
+    return true;
+}
+
+// 对比两种结构的插入和查找吞吐量
+void benchmark(size_t flowCount) {
+    std::cout << "\n[插入/查找性能对比] 流数量: " << flowCount << std::endl;
+    std::mt19937_64 rng(12345);
+    std::vector<FourTuple> tuples = generateTuples(flowCount, rng);
+    std::vector<FourTuple> misses = generateTuples(flowCount, rng);
+
+    // 以随机顺序查找
+    std::vector<size_t> order(flowCount);
+    for (size_t i = 0; i < flowCount; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    size_t checksum = 0;
+
+    // ---------- 旧实现：unordered_multimap<int, Flow*> ----------
+    {
+        // 模拟流对象：比较时需要解引用取出四元组
+        std::vector<FourTuple*> records(flowCount);
+        for (size_t i = 0; i < flowCount; i++) {
+            records[i] = new FourTuple(tuples[i]);
+        }
+        std::unordered_multimap<int, FourTuple*> flowMap;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < flowCount; i++) {
+            int hash = static_cast<int>(HashFlowTable::hashFourTuple(tuples[i]));
+            flowMap.insert(std::pair<int, FourTuple*>(hash, records[i]));
+        }
+        printRate("unordered_multimap 插入", flowCount, elapsedMs(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i : order) {
+            const FourTuple& key = tuples[i];
+            auto range = flowMap.equal_range(static_cast<int>(HashFlowTable::hashFourTuple(key)));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (*it->second == key) {
+                    checksum += reinterpret_cast<size_t>(it->second);
+                    break;
+                }
+            }
+        }
+        printRate("unordered_multimap 查找(命中)", flowCount, elapsedMs(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < flowCount; i++) {
+            const FourTuple& key = misses[i];
+            auto range = flowMap.equal_range(static_cast<int>(HashFlowTable::hashFourTuple(key)));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (*it->second == key) {
+                    checksum += 1;
+                    break;
+                }
+            }
+        }
+        printRate("unordered_multimap 查找(未命中)", flowCount, elapsedMs(start));
+
+        for (FourTuple* record : records) {
+            delete record;
+        }
+    }
+
+    // ---------- 新实现：FlowIndex ----------
+    {
+        FlowIndex index;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        // 与流表相同：每个四元组生成一次连接键，再由键计算哈希值
+        for (size_t i = 0; i < flowCount; i++) {
+            FlowKey key(tuples[i]);
+            index.insert(key, hashFlowKey(key), fakeFlow(i));
+        }
+        printRate("FlowIndex 插入", flowCount, elapsedMs(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i : order) {
+            FlowKey key(tuples[i]);
+            checksum += reinterpret_cast<size_t>(index.find(key, hashFlowKey(key)));
+        }
+        printRate("FlowIndex 查找(命中)", flowCount, elapsedMs(start));
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < flowCount; i++) {
+            FlowKey key(misses[i]);
+            checksum += reinterpret_cast<size_t>(index.find(key, hashFlowKey(key)));
+        }
+        printRate("FlowIndex 查找(未命中)", flowCount, elapsedMs(start));
+    }
+
+    // 防止编译器优化掉查找
+    std::cout << "  校验和: " << checksum << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "======= 流索引性能对比测试 =======" << std::endl;
+
+    size_t flowCount = 200000;
+    if (argc > 1) {
+        flowCount = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+
+    if (!test_correctness()) {
+        std::cerr << "FlowIndex正确性测试失败" << std::endl;
+        return 1;
+    }
+
+    benchmark(flowCount);
+
+    std::cout << "\n======= 测试完成 =======" << std::endl;
+    return 0;
+}
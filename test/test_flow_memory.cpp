@@ -0,0 +1,124 @@
+/**
+ * @file test_flow_memory.cpp
+ * @brief 流缓冲区内存占用测试
+ *
+ * 本测试文件验证流的环形缓冲区按需增长后，进程常驻内存(RSS)与实际缓冲的数据量成正比，
+ * 而不是与配置的缓冲区容量上限成正比。
+ *
+ * 测试步骤：
+ * 1. 以10MB的缓冲区容量上限打开N个空闲流（每个流只收到一条短命令），
+ *    记录RSS增量和每流平均占用。旧实现每个流预先分配并填充2 x 10MB。
+ * 2. 向其中1000个流各写入64KB未完结的数据，验证RSS增量与写入的数据量相当。
+ *
+ * RSS从/proc/self/statm读取，无法读取时只输出统计信息，不做检查。
+ *
+ * 用法: test_flow_memory [流数量]，默认100000
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 读取进程常驻内存（字节），失败返回0
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "======= 流缓冲区内存占用测试 =======" << std::endl;
+
+    size_t flowCount = 100000;
+    if (argc > 1) {
+        flowCount = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+    const size_t bufferCap = 10 * 1024 * 1024;
+    const size_t busyFlows = std::min<size_t>(1000, flowCount);
+    const size_t busyBytes = 64 * 1024;
+
+    size_t rssStart = 0;
+    size_t rssIdle = 0;
+    size_t rssBusy = 0;
+    size_t bufferedIdle = 0;
+    size_t bufferedBusy = 0;
+    size_t totalFlows = 0;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizes(bufferCap, bufferCap);
+
+        rssStart = residentBytes();
+
+        // 1. 空闲流：每个流只收到一条短命令
+        InputPacket packet;
+        packet.type = "C2S";
+        packet.payload = "a1 NOOP\r\n";
+        for (size_t i = 0; i < flowCount; i++) {
+            packet.fourTuple = makeTuple(i);
+            flowTable.processPacket(packet);
+        }
+        rssIdle = residentBytes();
+        bufferedIdle = flowTable.getBufferBytes();
+        totalFlows = flowTable.getTotalFlows();
+
+        // 2. 部分流缓冲大量未完结的数据（没有换行符，解析器会保留在缓冲区中）
+        packet.payload.assign(busyBytes, 'x');
+        for (size_t i = 0; i < busyFlows; i++) {
+            packet.fourTuple = makeTuple(i);
+            flowTable.processPacket(packet);
+        }
+        rssBusy = residentBytes();
+        bufferedBusy = flowTable.getBufferBytes();
+    }
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  流数量: " << totalFlows << "，每个方向缓冲区容量上限: " << bufferCap / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "  按容量上限预分配需要: " << (2.0 * bufferCap * flowCount) / (1024.0 * 1024 * 1024) << " GB" << std::endl;
+    std::cout << "  空闲流缓冲区实际分配: " << bufferedIdle / (1024.0 * 1024) << " MB" << std::endl;
+
+    if (rssStart == 0 || rssIdle == 0 || rssBusy == 0) {
+        std::cout << "  无法读取/proc/self/statm，跳过RSS检查" << std::endl;
+        std::cout << "\n======= 测试完成 =======" << std::endl;
+        return 0;
+    }
+
+    double idleDelta = static_cast<double>(rssIdle) - rssStart;
+    double busyDelta = static_cast<double>(rssBusy) - rssIdle;
+    double busyAdded = static_cast<double>(bufferedBusy) - bufferedIdle;
+    std::cout << "  空闲流RSS增量: " << idleDelta / (1024.0 * 1024) << " MB，每流 "
+              << idleDelta / flowCount << " 字节" << std::endl;
+    std::cout << "  " << busyFlows << " 个流各写入 " << busyBytes / 1024 << " KB后，缓冲区分配增加 "
+              << busyAdded / (1024.0 * 1024) << " MB，RSS增加 " << busyDelta / (1024.0 * 1024) << " MB" << std::endl;
+
+    // 空闲流每流占用应远小于一个缓冲区容量上限（流对象、索引槽位和少量缓冲区）
+    if (flowCount > 0 && idleDelta / flowCount > 16 * 1024) {
+        std::cerr << "错误: 空闲流的每流内存占用过大" << std::endl;
+        return 1;
+    }
+    // 写入数据后RSS的增长应与缓冲区实际分配的增长相当
+    if (busyDelta > 2.0 * busyAdded + 16.0 * 1024 * 1024) {
+        std::cerr << "错误: RSS增长超出缓冲数据量" << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n======= 测试完成 =======" << std::endl;
+    return 0;
+}
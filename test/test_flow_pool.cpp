@@ -0,0 +1,133 @@
+/**
+ * @file test_flow_pool.cpp
+ * @brief 流对象池测试
+ *
+ * 本测试文件验证流对象池(FlowPool)的正确性，以及流表在高频建连/断连时不再调用通用的内存分配。
+ *
+ * 主要测试功能：
+ * 1. 对象池基本测试 - 验证分配、释放、槽位复用、对齐和统计信息
+ * 2. 流表建连断连测试 - 预热后反复创建和删除流，统计全局operator new的调用次数应为0，
+ *    并验证对象池占用与流数量一致
+ */
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/flows/flow_pool.h"
+#include "../include/tools/types.h"
+
+#define TEST_COUNT_ALLOCATIONS
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 对象池基本功能
+bool test_pool_basic() {
+    std::cout << "\n[对象池基本测试]" << std::endl;
+    FlowPool pool(100, 8, 4);
+
+    std::vector<void*> slots;
+    for (int i = 0; i < 10; i++) {
+        slots.push_back(pool.allocate());
+    }
+    FlowPoolStats stats = pool.stats();
+    TEST_ASSERT(stats.inUse == 10, "正在使用10个槽位");
+    TEST_ASSERT(stats.slabs == 3 && stats.capacity == 12, "每块4个槽位，需要3块");
+
+    std::set<void*> unique(slots.begin(), slots.end());
+    bool aligned = true;
+    for (void* slot : slots) {
+        aligned &= reinterpret_cast<uintptr_t>(slot) % 8 == 0;
+    }
+    TEST_ASSERT(unique.size() == 10, "槽位互不重叠");
+    TEST_ASSERT(aligned, "槽位满足对齐要求");
+
+    // 刚释放的槽位被优先复用
+    pool.deallocate(slots[5]);
+    TEST_ASSERT(pool.allocate() == slots[5], "后进先出复用槽位");
+
+    for (void* slot : slots) {
+        pool.deallocate(slot);
+    }
+    stats = pool.stats();
+    TEST_ASSERT(stats.inUse == 0 && stats.capacity == 12, "释放后槽位留在池中");
+    return true;
+}
+
+// 流表高频建连断连
+bool test_table_churn() {
+    std::cout << "\n[流表建连断连测试]" << std::endl;
+    const size_t concurrent = 1000;
+    const size_t sessions = 100000;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(4096, 4096);
+
+    // 预热：建立concurrent个并发会话，使对象池和流索引达到稳定容量
+    std::vector<Flow*> live(concurrent);
+    for (size_t i = 0; i < concurrent; i++) {
+        live[i] = flowTable.getOrCreateFlow(makeTuple(i));
+    }
+    FlowPoolStats warm = flowTable.getPoolStats();
+
+    // 每个新会话替换一个旧会话（短连接收信场景）
+    size_t before = allocationCount;
+    for (size_t i = concurrent; i < sessions; i++) {
+        size_t slot = i % concurrent;
+        flowTable.deleteFlow(live[slot]);
+        live[slot] = flowTable.getOrCreateFlow(makeTuple(i));
+    }
+    size_t churnAllocations = allocationCount - before;
+    FlowPoolStats churned = flowTable.getPoolStats();
+    size_t flowsAfterChurn = flowTable.getTotalFlows();
+
+    for (Flow* flow : live) {
+        flowTable.deleteFlow(flow);
+    }
+    FlowPoolStats drained = flowTable.getPoolStats();
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    std::cout << "  对象池: " << churned.slabs << " 块, " << churned.capacity << " 个槽位, "
+              << churned.inUse << " 个正在使用" << std::endl;
+    std::cout << "  " << (sessions - concurrent) << " 次建连断连中的通用内存分配次数: " << churnAllocations << std::endl;
+    TEST_ASSERT(churnAllocations == 0, "稳定后建连断连不调用通用的内存分配");
+    TEST_ASSERT(churned.inUse == flowsAfterChurn && flowsAfterChurn == concurrent, "对象池占用等于流数量");
+    TEST_ASSERT(churned.capacity == warm.capacity, "建连断连不增加对象池容量");
+    TEST_ASSERT(drained.inUse == 0, "删除所有流后对象池为空");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 流对象池测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_pool_basic();
+    allPassed &= test_table_churn();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
@@ -0,0 +1,307 @@
+/**
+ * @file test_flow_stats.cpp
+ * @brief 流表统计测试
+ *
+ * 本测试文件验证HashFlowTable::getStats()返回的计数器与流表的实际状态一致，
+ * 以及多个流表的统计可以在工作线程处理数据包的同时从其他线程读取并汇总。
+ *
+ * 主要测试功能：
+ * 1. 计数器测试 - 数据包、新建流、解析出的消息、解析错误、LOGOUT删除、淘汰和单个缓冲区峰值
+ * 2. 缓冲区占用测试 - 两个方向的缓冲区占用之和等于流表的缓冲区总量，删除流后归零
+ * 3. 超时测试 - 超时删除的流计入超时数量
+ * 4. 连接关闭测试 - 关闭时解析剩余的完整命令并输出，流被立即删除并计入关闭数量
+ * 5. 流缓存测试 - 同一连接上连续的数据包命中最近使用流缓存，流被删除后缓存不再返回它
+ * 6. 并发读取测试 - 工作线程处理数据包时，统计线程读取到的累计值单调不减，结束后汇总正确
+ */
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 计数器与流表状态一致
+bool test_counters() {
+    std::cout << "\n[计数器测试]" << std::endl;
+    const std::string login = "a1 LOGIN user pass\r\n";
+    const std::string select = "a2 SELECT INBOX\r\n";
+    const std::string invalid = "+bad command\r\n";
+    const std::string logout = "a3 LOGOUT\r\n";
+    const std::string partial = "a4 FETCH 1 (FLAGS";
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    FlowTableStats stats, afterEviction, empty;
+    size_t totalFlows, bufferBytes, afterEvictionBytes;
+    {
+        HashFlowTable flowTable;
+        empty = flowTable.getStats();
+
+        // 流0：两条命令和一行不合法的命令；流1：LOGOUT后删除；流2：未完成的命令留在缓冲区
+        flowTable.processPacket(makeView(0, PacketDirection::C2S, login));
+        flowTable.processPacket(makeView(0, PacketDirection::C2S, select));
+        flowTable.processPacket(makeView(0, PacketDirection::C2S, invalid));
+        flowTable.processPacket(makeView(1, PacketDirection::C2S, login));
+        flowTable.processPacket(makeView(1, PacketDirection::C2S, logout));
+        flowTable.processPacket(makeView(2, PacketDirection::C2S, partial));
+        stats = flowTable.getStats();
+        totalFlows = flowTable.getTotalFlows();
+        bufferBytes = flowTable.getBufferBytes();
+
+        // 流数量上限为1时淘汰最久未活动的流
+        flowTable.setMaxFlows(1);
+        afterEviction = flowTable.getStats();
+        afterEvictionBytes = flowTable.getBufferBytes();
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(empty.packets == 0 && empty.activeFlows == 0 && empty.flowsCreated == 0, "新建的流表计数器为0");
+    TEST_ASSERT(stats.packets == 6, "数据包数量");
+    TEST_ASSERT(stats.flowsCreated == 3, "新建流数量");
+    TEST_ASSERT(stats.activeFlows == totalFlows && totalFlows == 2, "当前流数量与流表一致");
+    TEST_ASSERT(stats.messagesParsed == 4, "解析出的消息数量（LOGIN两次、SELECT、LOGOUT）");
+    TEST_ASSERT(stats.parseErrors == 1, "不合法的命令计入解析错误");
+    TEST_ASSERT(stats.logoutDeletions == 1, "LOGOUT删除的流数量");
+    TEST_ASSERT(stats.peakRingBytes == login.size(), "单个缓冲区峰值为最长的一次缓存");
+    TEST_ASSERT(stats.c2sBufferBytes + stats.s2cBufferBytes == bufferBytes, "两个方向的缓冲区占用之和等于总量");
+    TEST_ASSERT(stats.c2sBufferBytes > 0 && stats.s2cBufferBytes == 0, "只有C2S方向分配了存储");
+    TEST_ASSERT(afterEviction.evictions == 1 && afterEviction.activeFlows == 1, "淘汰计入统计");
+    TEST_ASSERT(afterEviction.c2sBufferBytes + afterEviction.s2cBufferBytes == afterEvictionBytes,
+                "淘汰后缓冲区占用与总量一致");
+    return true;
+}
+
+// 超时删除计入统计
+bool test_timeouts() {
+    std::cout << "\n[超时测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    FlowTableStats stats;
+    {
+        HashFlowTable flowTable;
+        flowTable.setTimeSource(TimeSourceMode::Packet);
+        flowTable.setFlowTimeout(1000);
+        for (size_t i = 0; i < 5; i++) {
+            flowTable.processPacket(makeView(i, PacketDirection::C2S, "a1 NOOP\r\n", 10000));
+        }
+        // 只有流5在超时时间内有活动
+        flowTable.processPacket(makeView(5, PacketDirection::S2C, "* OK\r\n", 20000));
+        flowTable.checkAndCleanupTimeoutFlows();
+        stats = flowTable.getStats();
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(stats.timeouts == 5, "超时删除的流数量");
+    TEST_ASSERT(stats.activeFlows == 1, "剩余一个流");
+    TEST_ASSERT(stats.c2sBufferBytes == 0 && stats.s2cBufferBytes > 0, "超时删除后C2S方向不再占用存储");
+    return true;
+}
+
+// 连接关闭时解析剩余的完整命令并立即删除流
+bool test_close_flow() {
+    std::cout << "\n[连接关闭测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    FlowTableStats stats;
+    std::ostringstream output;
+    bool closed, closedAgain, unknownClosed;
+    size_t totalFlows, bufferBytes;
+    {
+        HashFlowTable flowTable;
+        // 一个数据包中有三条完整的命令和半条命令，处理数据包时只解析第一条
+        flowTable.processPacket(makeView(0, PacketDirection::C2S,
+            "a1 LOGIN user pass\r\na2 SELECT INBOX\r\na3 NOOP\r\na4 FET"));
+        flowTable.processPacket(makeView(1, PacketDirection::C2S, "b1 NOOP\r\n"));
+
+        // 关闭通告来自服务器方向
+        closed = flowTable.closeFlow(makeTuple(0).reversed(), output);
+        closedAgain = flowTable.closeFlow(makeTuple(0), output);
+        unknownClosed = flowTable.closeFlow(makeTuple(99), output);
+        stats = flowTable.getStats();
+        totalFlows = flowTable.getTotalFlows();
+        bufferBytes = flowTable.getBufferBytes();
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(closed, "关闭已存在的流");
+    TEST_ASSERT(!closedAgain && !unknownClosed, "关闭不存在的流返回false且不创建流");
+    TEST_ASSERT(output.str().find("SELECT") != std::string::npos &&
+                output.str().find("NOOP") != std::string::npos, "关闭时解析并输出剩余的完整命令");
+    TEST_ASSERT(stats.messagesParsed == 4, "剩余的两条命令计入解析出的消息");
+    TEST_ASSERT(stats.closes == 1 && totalFlows == 1 && stats.activeFlows == 1, "流被删除并计入关闭数量");
+    TEST_ASSERT(stats.c2sBufferBytes + stats.s2cBufferBytes == bufferBytes, "缓冲区占用随流释放");
+    TEST_ASSERT(stats.logoutDeletions == 0 && stats.timeouts == 0 && stats.evictions == 0, "其他结束原因不计数");
+    return true;
+}
+
+// 最近使用流缓存的命中统计和失效
+bool test_flow_cache() {
+    std::cout << "\n[流缓存测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    FlowTableStats burst, afterClose, afterTimeout, afterEviction;
+    size_t flowsAfterEviction;
+    {
+        HashFlowTable flowTable;
+        flowTable.setTimeSource(TimeSourceMode::Packet);
+        flowTable.setFlowTimeout(1000);
+
+        // 同一连接上两个方向连续的数据包，只有第一个数据包未命中
+        for (size_t n = 0; n < 100; n++) {
+            PacketDirection direction = n % 2 == 0 ? PacketDirection::C2S : PacketDirection::S2C;
+            flowTable.processPacket(makeView(0, direction, n % 2 == 0 ? "a1 NOOP\r\n" : "a1 OK\r\n", 10000));
+        }
+        burst = flowTable.getStats();
+
+        // 关闭后同一四元组的数据包创建新流，而不是返回已删除的流
+        std::ostringstream output;
+        flowTable.closeFlow(makeTuple(0), output);
+        flowTable.processPacket(makeView(0, PacketDirection::C2S, "b1 NOOP\r\n", 10000));
+        afterClose = flowTable.getStats();
+
+        // 超时删除后同样创建新流
+        flowTable.processPacket(makeView(1, PacketDirection::C2S, "c1 NOOP\r\n", 20000));
+        flowTable.checkAndCleanupTimeoutFlows();
+        flowTable.processPacket(makeView(0, PacketDirection::C2S, "d1 NOOP\r\n", 20000));
+        afterTimeout = flowTable.getStats();
+
+        // 最多一个流时，两个连接交替到达，每个数据包都淘汰另一个流
+        flowTable.setMaxFlows(1);
+        for (size_t n = 0; n < 10; n++) {
+            flowTable.processPacket(makeView(n % 2, PacketDirection::C2S, "e1 NOOP\r\n", 20000));
+        }
+        afterEviction = flowTable.getStats();
+        flowsAfterEviction = flowTable.getTotalFlows();
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(burst.cacheLookups == 100 && burst.cacheHits == 99, "连续的数据包命中缓存");
+    TEST_ASSERT(burst.cacheHitRate() == 0.99, "命中率");
+    TEST_ASSERT(afterClose.flowsCreated == 2 && afterClose.cacheHits == burst.cacheHits, "关闭的流不再命中缓存");
+    TEST_ASSERT(afterTimeout.timeouts == 1 && afterTimeout.flowsCreated == 4 && afterTimeout.activeFlows == 2,
+                "超时删除的流不再命中缓存");
+    TEST_ASSERT(afterEviction.flowsCreated == afterTimeout.flowsCreated + 9 && flowsAfterEviction == 1,
+                "淘汰的流不再命中缓存");
+    return true;
+}
+
+// 工作线程处理数据包的同时从其他线程读取统计
+bool test_concurrent_snapshot() {
+    std::cout << "\n[并发读取测试]" << std::endl;
+    const size_t workerCount = 4;
+    const size_t packetsPerWorker = 20000;
+    const size_t flowsPerWorker = 50;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    std::vector<HashFlowTable*> tables;
+    for (size_t w = 0; w < workerCount; w++) {
+        tables.push_back(new HashFlowTable());
+    }
+
+    std::atomic<bool> done(false);
+    bool monotonic = true;
+    size_t snapshots = 0;
+    std::thread reader([&]() {
+        uint64_t lastPackets = 0;
+        uint64_t lastMessages = 0;
+        while (!done.load()) {
+            FlowTableStats total;
+            for (HashFlowTable* table : tables) {
+                total += table->getStats();
+            }
+            if (total.packets < lastPackets || total.messagesParsed < lastMessages) {
+                monotonic = false;
+            }
+            lastPackets = total.packets;
+            lastMessages = total.messagesParsed;
+            ++snapshots;
+        }
+    });
+
+    std::vector<std::thread> workers;
+    const std::string command = "a1 NOOP\r\n";
+    for (size_t w = 0; w < workerCount; w++) {
+        workers.emplace_back([&, w]() {
+            for (size_t n = 0; n < packetsPerWorker; n++) {
+                tables[w]->processPacket(makeView(w * flowsPerWorker + n % flowsPerWorker, PacketDirection::C2S, command));
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    done.store(true);
+    reader.join();
+
+    FlowTableStats total;
+    for (HashFlowTable* table : tables) {
+        total += table->getStats();
+        delete table;
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    std::cout << "  统计线程读取了 " << snapshots << " 次" << std::endl;
+    TEST_ASSERT(monotonic, "读取到的累计值单调不减");
+    TEST_ASSERT(total.packets == workerCount * packetsPerWorker, "汇总的数据包数量");
+    TEST_ASSERT(total.messagesParsed == workerCount * packetsPerWorker, "汇总的消息数量");
+    TEST_ASSERT(total.activeFlows == workerCount * flowsPerWorker, "汇总的流数量");
+    TEST_ASSERT(total.peakRingBytes == command.size(), "峰值取各流表的最大值");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 流表统计测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_counters();
+    allPassed &= test_timeouts();
+    allPassed &= test_close_flow();
+    allPassed &= test_flow_cache();
+    allPassed &= test_concurrent_snapshot();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
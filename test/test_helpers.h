@@ -0,0 +1,74 @@
+/**
+ * @file test_helpers.h
+ * @brief 流表测试共用的辅助函数
+ *
+ * 每个测试是单独的可执行文件，本头文件只在测试中包含：
+ * - NullBuffer：丢弃所有输出，测试时屏蔽流表的打印
+ * - makeTuple/makeView：按序号生成互不相同的四元组和数据包视图
+ * - 定义TEST_COUNT_ALLOCATIONS后包含本文件时，替换全局operator new/delete并统计调用次数
+ *   （替换函数只能定义一次，只能在一个测试的一个源文件中这样包含）
+ */
+
+#ifndef FLOW_TABLE_TEST_HELPERS_H
+#define FLOW_TABLE_TEST_HELPERS_H
+
+#include <streambuf>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+
+#ifdef TEST_COUNT_ALLOCATIONS
+#include <new>
+#include <cstdlib>
+
+// 统计全局operator new的调用次数
+static size_t allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+#endif
+
+// 丢弃所有输出的流缓冲区
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// 根据序号生成唯一的IPv4四元组（客户端到服务器方向）
+inline FourTuple makeTuple(size_t i) {
+    FourTuple tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    tuple.srcIPvN = 4;
+    tuple.dstIPvN = 4;
+    tuple.srcIPv4 = 0x0A000000u + static_cast<unsigned int>(i / 60000);
+    tuple.dstIPv4 = 0xC0A80001u;
+    tuple.sourcePort = 1024 + static_cast<int>(i % 60000);
+    tuple.destPort = 143;
+    return tuple;
+}
+
+// 生成指向payload的数据包视图（四元组为数据包自身方向）
+inline flow_table::PacketView makeView(size_t i, flow_table::PacketDirection direction,
+                                       const std::string& payload, int64_t timestamp = 0) {
+    flow_table::PacketView view;
+    view.data = payload.data();
+    view.length = payload.size();
+    view.direction = direction;
+    view.fourTuple = direction == flow_table::PacketDirection::C2S ? makeTuple(i) : makeTuple(i).reversed();
+    view.timestamp = timestamp;
+    return view;
+}
+
+#endif // FLOW_TABLE_TEST_HELPERS_H
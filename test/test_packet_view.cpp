@@ -0,0 +1,175 @@
+/**
+ * @file test_packet_view.cpp
+ * @brief 零拷贝数据包路径测试
+ *
+ * 本测试文件验证数据包视图(PacketView)的处理结果与InputPacket相同，
+ * 并统计全局operator new的调用次数，验证稳定状态下数据包路径不调用通用的内存分配。
+ *
+ * 主要测试功能：
+ * 1. 一致性测试 - 同一组IMAP数据包分别以PacketView和InputPacket处理，解析结果相同
+ * 2. 稳定状态分配测试 - 流和缓冲区预热后，以PacketView处理数据包（逐个和批量）以及向S2C缓冲区
+ *    追加载荷时operator new的调用次数为0
+ *
+ * 注意：S2C解析器用异常报告无法解析的响应，每次抛出异常都会分配内存，
+ * 这属于解析器本身，因此稳定状态的逐包测试使用C2S数据包，S2C方向只测试追加载荷。
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+
+#define TEST_COUNT_ALLOCATIONS
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// PacketView与InputPacket处理结果相同
+bool test_equivalence() {
+    std::cout << "\n[一致性测试]" << std::endl;
+    const std::vector<std::string> c2sPayloads = {"a1 LOGIN user pass\r\n", "a2 SELECT INBOX\r\n", "a3 FETCH 1 (FL", "AGS)\r\n"};
+    const std::string s2cPayload = "a1 OK LOGIN completed\r\n";
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    std::ostringstream viewOutput;
+    std::ostringstream packetOutput;
+    bool unknownRejected;
+    {
+        HashFlowTable viewTable;
+        HashFlowTable packetTable;
+        for (size_t flowId = 0; flowId < 3; flowId++) {
+            for (const std::string& payload : c2sPayloads) {
+                viewTable.processPacket(makeView(flowId, PacketDirection::C2S, payload));
+
+                InputPacket packet;
+                packet.type = "C2S";
+                packet.fourTuple = makeTuple(flowId);
+                packet.payload = payload;
+                packetTable.processPacket(packet);
+            }
+            viewTable.processPacket(makeView(flowId, PacketDirection::S2C, s2cPayload));
+
+            InputPacket packet;
+            packet.type = "S2C";
+            packet.fourTuple = makeTuple(flowId).reversed();
+            packet.payload = s2cPayload;
+            packetTable.processPacket(packet);
+        }
+        viewTable.outputResults(viewOutput);
+        packetTable.outputResults(packetOutput);
+
+        InputPacket unknown;
+        unknown.type = "XYZ";
+        unknown.fourTuple = makeTuple(99);
+        unknown.payload = "data";
+        unknownRejected = !packetTable.processPacket(unknown) && packetTable.getTotalFlows() == 3;
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    TEST_ASSERT(!viewOutput.str().empty(), "解析出了消息");
+    TEST_ASSERT(viewOutput.str() == packetOutput.str(), "两种数据包的解析结果相同");
+    TEST_ASSERT(unknownRejected, "未知类型的数据包被拒绝且不创建流");
+    return true;
+}
+
+// 稳定状态下数据包路径不分配内存
+bool test_steady_state_allocations() {
+    std::cout << "\n[稳定状态分配测试]" << std::endl;
+    const size_t flowCount = 100;
+    const size_t packetCount = 100000;
+    // 模拟TASK::Buffer中的载荷：一段不完整的命令行，解析只查找换行符
+    const std::string payload(64, 'A');
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+    std::streambuf* oldCerrStreamBuf = std::cerr.rdbuf(&nullBuffer);
+
+    size_t viewAllocations = 0;
+    size_t batchAllocations = 0;
+    size_t appendAllocations = 0;
+    size_t totalFlows = 0;
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizes(512, 512);
+
+        // 预热：建立所有流，并让每个流的两个缓冲区增长到容量上限
+        for (size_t round = 0; round < 16; round++) {
+            for (size_t i = 0; i < flowCount; i++) {
+                flowTable.processPacket(makeView(i, PacketDirection::C2S, payload));
+                flowTable.processPacket(makeView(i, PacketDirection::S2C, payload));
+            }
+        }
+
+        std::vector<PacketView> batch(64);
+        size_t before = allocationCount;
+        for (size_t n = 0; n < packetCount; n++) {
+            flowTable.processPacket(makeView(n % flowCount, PacketDirection::C2S, payload));
+        }
+        viewAllocations = allocationCount - before;
+
+        before = allocationCount;
+        for (size_t n = 0; n < packetCount; n += batch.size()) {
+            for (size_t i = 0; i < batch.size(); i++) {
+                batch[i] = makeView((n + i) % flowCount, PacketDirection::C2S, payload);
+            }
+            flowTable.processBatch(batch.data(), batch.size());
+        }
+        batchAllocations = allocationCount - before;
+
+        // S2C方向：载荷从调用者的缓冲区直接写入环形缓冲区
+        before = allocationCount;
+        for (size_t n = 0; n < packetCount; n++) {
+            Flow* flow = flowTable.getOrCreateFlow(makeTuple(n % flowCount).reversed(), false);
+            flow->addS2CData(payload.data(), payload.size());
+        }
+        appendAllocations = allocationCount - before;
+        totalFlows = flowTable.getTotalFlows();
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+    std::cerr.rdbuf(oldCerrStreamBuf);
+
+    std::cout << "  " << packetCount << " 个数据包的通用内存分配次数: 逐个 " << viewAllocations
+              << ", 批量 " << batchAllocations << ", S2C追加 " << appendAllocations << std::endl;
+    TEST_ASSERT(totalFlows == flowCount, "没有新建流");
+    TEST_ASSERT(viewAllocations == 0, "逐个处理数据包视图不调用通用的内存分配");
+    TEST_ASSERT(batchAllocations == 0, "批量处理数据包视图不调用通用的内存分配");
+    TEST_ASSERT(appendAllocations == 0, "向S2C缓冲区追加载荷不调用通用的内存分配");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 零拷贝数据包路径测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_equivalence();
+    allPassed &= test_steady_state_allocations();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
@@ -16,6 +16,9 @@
 #include <cstring>
 #include <arpa/inet.h>
 #include <dlfcn.h>
+#include <thread>
+#include <vector>
+#include <utility>
 #include "../include/plugin/plugin.h"
 
 // 辅助函数：打印使用帮助
@@ -24,6 +27,137 @@ void printUsage(const char* programName) {
     std::cout << "  如果未指定配置文件路径，将使用默认搜索路径" << std::endl;
 }
 
+// 构造一个带IMAP命令的C2S任务
+TASK makeC2STask(unsigned short thread, unsigned short clientPort, const std::string& data) {
+    TASK task;
+    memset(&task, 0, sizeof(TASK));
+    task.Inform = 0x12;
+    task.Thread = thread;
+    task.Source.Role = 'C';
+    task.Source.IPvN = 4;
+    task.Source.IPv4 = inet_addr("192.168.1.1");
+    task.Source.Port = clientPort;
+    task.Target.Role = 'S';
+    task.Target.IPvN = 4;
+    task.Target.IPv4 = inet_addr("192.168.1.2");
+    task.Target.Port = 143;
+    task.Buffer = (unsigned char*)data.c_str();
+    task.Length = data.length();
+    return task;
+}
+
+// 多个工作线程并发调用Filter，每个线程使用自己的流表
+bool testMultiThreadFilter() {
+    const unsigned short threadCount = 4;
+    const int packetsPerThread = 20;
+    for (unsigned short t = 1; t <= threadCount; t++) {
+        if (Single(t, nullptr) != 0) {
+            std::cerr << "线程" << t << "初始化失败" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<int> forwarded(threadCount + 1, 0);
+    std::vector<std::thread> workers;
+    const std::string command = "A001 NOOP\r\n";
+    for (unsigned short t = 1; t <= threadCount; t++) {
+        workers.emplace_back([t, &forwarded, &command, packetsPerThread]() {
+            for (int i = 0; i < packetsPerThread; i++) {
+                // 每个线程处理自己的几条连接
+                TASK task = makeC2STask(t, static_cast<unsigned short>(20000 + t * 100 + i % 3), command);
+                TASK* exported = nullptr;
+                if (Filter(&task, &exported) == 0 && exported->Action == 0x22) {
+                    forwarded[t]++;
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (unsigned short t = 1; t <= threadCount; t++) {
+        if (forwarded[t] != packetsPerThread) {
+            std::cerr << "线程" << t << "只转发了" << forwarded[t] << "个数据包" << std::endl;
+            return false;
+        }
+    }
+
+    // 汇总统计包含所有线程的流表
+    flow_table::FlowTableStats stats;
+    GetFlowStats(&stats);
+    if (stats.packets < static_cast<uint64_t>(threadCount * packetsPerThread) ||
+        stats.messagesParsed < static_cast<uint64_t>(threadCount * packetsPerThread) ||
+        stats.activeFlows < static_cast<uint64_t>(threadCount * 3)) {
+        std::cerr << "汇总统计不完整: 数据包 " << stats.packets << ", 消息 " << stats.messagesParsed
+                  << ", 流 " << stats.activeFlows << std::endl;
+        return false;
+    }
+
+    // 未初始化的线程编号不处理数据包，只返回知晓
+    TASK orphan = makeC2STask(threadCount + 10, 30000, command);
+    TASK* exported = nullptr;
+    Filter(&orphan, &exported);
+    if (exported->Action != 0x21) {
+        std::cerr << "未初始化线程的数据包不应被处理" << std::endl;
+        return false;
+    }
+
+    // 超出范围的线程编号初始化失败
+    if (Single(PLUGIN_MAX_THREADS, nullptr) == 0) {
+        std::cerr << "超出范围的线程编号应初始化失败" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 连接关闭通告(0x13)立即释放流
+bool testCloseNotification() {
+    const unsigned short thread = 6;
+    if (Single(thread, nullptr) != 0) {
+        return false;
+    }
+
+    const std::string command = "A001 NOOP\r\nA002 SELECT INBOX\r\n";
+    TASK data = makeC2STask(thread, 30000, command);
+    TASK* exported = nullptr;
+    Filter(&data, &exported);
+
+    flow_table::FlowTableStats before;
+    GetFlowStats(&before);
+
+    // 服务器方向发出的关闭通告，四元组与数据包方向相反
+    TASK close = makeC2STask(thread, 30000, "");
+    close.Inform = 0x13;
+    std::swap(close.Source, close.Target);
+    Filter(&close, &exported);
+    if (exported->Action != 0x21) {
+        std::cerr << "关闭通告应返回知晓" << std::endl;
+        return false;
+    }
+
+    flow_table::FlowTableStats after;
+    GetFlowStats(&after);
+    if (after.closes != before.closes + 1 || after.activeFlows != before.activeFlows - 1) {
+        std::cerr << "关闭通告没有删除流" << std::endl;
+        return false;
+    }
+    // 缓冲区中剩余的第二条命令在关闭时被解析
+    if (after.messagesParsed != before.messagesParsed + 1) {
+        std::cerr << "关闭时没有解析剩余的完整命令" << std::endl;
+        return false;
+    }
+
+    // 已关闭的连接再次收到关闭通告时什么也不做
+    Filter(&close, &exported);
+    GetFlowStats(&before);
+    if (before.closes != after.closes) {
+        std::cerr << "重复的关闭通告不应计数" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 // 主函数
 int main(int argc, char* argv[]) {
     std::cout << "===== IMAP流量分析和关键词检测插件测试程序 =====" << std::endl;
@@ -119,10 +253,20 @@ int main(int argc, char* argv[]) {
     int s2cResult = Filter(&s2cTask, &exportS2CTask);
     std::cout << "Filter返回值: " << s2cResult << std::endl;
     
-    // 5. 资源清理
-    std::cout << "\n5. 调用 Remove()" << std::endl;
+    // 5. 多线程处理
+    std::cout << "\n5. 多个工作线程并发调用 Filter()" << std::endl;
+    bool multiThreadOk = testMultiThreadFilter();
+    std::cout << "多线程测试: " << (multiThreadOk ? "通过" : "失败") << std::endl;
+    
+    // 6. 连接关闭通告
+    std::cout << "\n6. 连接关闭通告" << std::endl;
+    bool closeOk = testCloseNotification();
+    std::cout << "关闭通告测试: " << (closeOk ? "通过" : "失败") << std::endl;
+    
+    // 7. 资源清理（释放所有线程的流表）
+    std::cout << "\n7. 调用 Remove()" << std::endl;
     Remove();
     
     std::cout << "\n===== 测试完成 =====" << std::endl;
-    return 0;
+    return multiThreadOk && closeOk ? 0 : 1;
 }
@@ -0,0 +1,237 @@
+/**
+ * @file test_symmetric_hash.cpp
+ * @brief 对称流哈希测试
+ *
+ * 本测试文件验证HashFlowTable的四元组哈希对两个方向对称，
+ * 同一连接两个方向的数据包无需改写四元组即可找到同一个流，并被分配到同一个工作线程。
+ *
+ * 主要测试功能：
+ * 1. 对称性测试 - IPv4和IPv6四元组与其反方向的哈希值和所属分片相同
+ * 2. 区分度测试 - 不同连接的哈希值互不相同
+ * 3. 分片均衡测试 - 连接在各分片之间分布均匀，分片内部的索引低位仍然分散
+ * 4. 双向数据包测试 - 两个方向的数据包进入同一个流，服务器先发数据时流的方向仍以客户端为源端
+ * 5. 连接键测试 - 两个方向的四元组生成相同的规范化键，不同连接的键不同，键与四元组的匹配结果一致
+ */
+
+#include <iostream>
+#include <set>
+#include <vector>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 根据序号生成唯一的IPv6四元组（客户端到服务器方向）
+FourTuple makeTupleV6(size_t i) {
+    FourTuple tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    tuple.srcIPvN = 6;
+    tuple.dstIPvN = 6;
+    tuple.srcIPv6[0] = 0x20;
+    tuple.srcIPv6[1] = 0x01;
+    tuple.srcIPv6[14] = static_cast<unsigned char>(i >> 8);
+    tuple.srcIPv6[15] = static_cast<unsigned char>(i);
+    tuple.dstIPv6[0] = 0x20;
+    tuple.dstIPv6[1] = 0x01;
+    tuple.dstIPv6[15] = 0x01;
+    tuple.sourcePort = 1024 + static_cast<int>(i % 60000);
+    tuple.destPort = 993;
+    return tuple;
+}
+
+// 两个四元组是否属于同一个连接（同方向相等或互为反方向），作为FlowKey比较的参照
+bool sameConnection(const FourTuple& a, const FourTuple& b) {
+    return a == b || a == b.reversed();
+}
+
+// 两个方向的哈希值和所属分片相同
+bool test_symmetry() {
+    std::cout << "\n[对称性测试]" << std::endl;
+    bool v4Symmetric = true;
+    bool v6Symmetric = true;
+    bool shardSymmetric = true;
+    for (size_t i = 0; i < 10000; i++) {
+        FourTuple v4 = makeTuple(i * 7919);
+        FourTuple v6 = makeTupleV6(i);
+        v4Symmetric &= HashFlowTable::hashFourTuple(v4) == HashFlowTable::hashFourTuple(v4.reversed());
+        v6Symmetric &= HashFlowTable::hashFourTuple(v6) == HashFlowTable::hashFourTuple(v6.reversed());
+        shardSymmetric &= HashFlowTable::ownerShard(v4, 12) == HashFlowTable::ownerShard(v4.reversed(), 12);
+    }
+    TEST_ASSERT(v4Symmetric, "IPv4四元组两个方向的哈希值相同");
+    TEST_ASSERT(v6Symmetric, "IPv6四元组两个方向的哈希值相同");
+    TEST_ASSERT(shardSymmetric, "两个方向属于同一个分片");
+
+    FourTuple tuple = makeTuple(42);
+    TEST_ASSERT(!(tuple.reversed() == tuple) && tuple.reversed().reversed() == tuple, "反转两次得到原四元组");
+    TEST_ASSERT(sameConnection(tuple, tuple.reversed()) && !sameConnection(tuple, makeTuple(43)), "按连接匹配四元组");
+    return true;
+}
+
+// 不同连接的哈希值互不相同
+bool test_distinct() {
+    std::cout << "\n[区分度测试]" << std::endl;
+    const size_t count = 200000;
+    std::set<uint64_t> hashes;
+    for (size_t i = 0; i < count; i++) {
+        hashes.insert(HashFlowTable::hashFourTuple(makeTuple(i)));
+    }
+    std::cout << "  " << count << " 个连接得到 " << hashes.size() << " 个不同的哈希值" << std::endl;
+    TEST_ASSERT(hashes.size() == count, "不同连接的哈希值不同");
+
+    // 只交换端口（而非端点）会得到不同的连接
+    FourTuple tuple = makeTuple(1);
+    FourTuple swappedPorts = tuple;
+    swappedPorts.sourcePort = tuple.destPort;
+    swappedPorts.destPort = tuple.sourcePort;
+    TEST_ASSERT(HashFlowTable::hashFourTuple(tuple) != HashFlowTable::hashFourTuple(swappedPorts), "端口与IP的组合参与哈希");
+    return true;
+}
+
+// 分片均衡，且分片内的哈希低位仍然分散
+bool test_shard_balance() {
+    std::cout << "\n[分片均衡测试]" << std::endl;
+    const size_t count = 100000;
+    const unsigned int shards = 8;
+    std::vector<size_t> perShard(shards, 0);
+    std::set<uint64_t> lowBitsInShard0;
+    for (size_t i = 0; i < count; i++) {
+        FourTuple tuple = makeTuple(i);
+        unsigned int shard = HashFlowTable::ownerShard(tuple, shards);
+        perShard[shard]++;
+        if (shard == 0) {
+            lowBitsInShard0.insert(HashFlowTable::hashFourTuple(tuple) & 0x3FF);
+        }
+    }
+    size_t minCount = count;
+    size_t maxCount = 0;
+    for (size_t n : perShard) {
+        minCount = n < minCount ? n : minCount;
+        maxCount = n > maxCount ? n : maxCount;
+    }
+    std::cout << "  每个分片的连接数: " << minCount << " ~ " << maxCount << std::endl;
+    TEST_ASSERT(minCount > count / shards * 9 / 10 && maxCount < count / shards * 11 / 10, "各分片连接数相差不超过10%");
+    TEST_ASSERT(lowBitsInShard0.size() > 1000, "分片内的流仍分散到索引的各个槽位");
+    TEST_ASSERT(HashFlowTable::ownerShard(makeTuple(1), 1) == 0 && HashFlowTable::ownerShard(makeTuple(1), 0) == 0, "单分片时总是0");
+    return true;
+}
+
+// 双向数据包进入同一个流
+bool test_bidirectional_packets() {
+    std::cout << "\n[双向数据包测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    HashFlowTable flowTable;
+    flowTable.setBufferSizes(4096, 4096);
+
+    // 客户端先发数据，服务器的响应使用数据包自身的方向（未改写）
+    FourTuple client = makeTuple(7);
+    InputPacket request;
+    request.type = "C2S";
+    request.fourTuple = client;
+    request.payload = "a1 NOOP\r\n";
+    flowTable.processPacket(request);
+
+    InputPacket response;
+    response.type = "S2C";
+    response.fourTuple = client.reversed();
+    response.payload = "a1 OK NOOP completed\r\n";
+    flowTable.processPacket(response);
+    size_t flowsAfterFirst = flowTable.getTotalFlows();
+
+    // 服务器先发数据（问候语），流的C2S方向仍以客户端为源端
+    FourTuple second = makeTupleV6(9);
+    InputPacket greeting;
+    greeting.type = "S2C";
+    greeting.fourTuple = second.reversed();
+    greeting.payload = "* OK IMAP4rev1 ready\r\n";
+    flowTable.processPacket(greeting);
+    Flow* secondFlow = flowTable.getOrCreateFlow(second);
+    size_t flowsAfterSecond = flowTable.getTotalFlows();
+
+    // 规范化为C2S方向的四元组也能找到同一个流
+    Flow* byC2S = flowTable.getOrCreateFlow(client);
+    Flow* byS2C = flowTable.getOrCreateFlow(client.reversed(), false);
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(flowsAfterFirst == 1, "请求和响应属于同一个流");
+    TEST_ASSERT(flowsAfterSecond == 2, "服务器先发数据时只创建一个流");
+    TEST_ASSERT(secondFlow->getC2STuple() == second, "服务器先发数据时流的C2S方向以客户端为源端");
+    TEST_ASSERT(secondFlow->getS2CTuple() == second.reversed(), "S2C方向为C2S方向的反转");
+    TEST_ASSERT(byC2S == byS2C && byC2S->getC2STuple() == client, "两个方向的四元组找到同一个流");
+
+    flowTable.deleteFlow(byS2C);
+    TEST_ASSERT(flowTable.getTotalFlows() == 1, "删除后流数量减少");
+    return true;
+}
+
+// 规范化连接键
+bool test_flow_key() {
+    std::cout << "\n[连接键测试]" << std::endl;
+    bool canonical = true;
+    bool matchesTuple = true;
+    for (size_t i = 0; i < 1000; i++) {
+        FourTuple v4 = makeTuple(i * 7919);
+        FourTuple v6 = makeTupleV6(i);
+        canonical &= FlowKey(v4) == FlowKey(v4.reversed()) && FlowKey(v6) == FlowKey(v6.reversed());
+        // 键相等当且仅当四元组属于同一连接
+        FourTuple other = makeTuple(i * 7919 + 1);
+        matchesTuple &= (FlowKey(v4) == FlowKey(other)) == sameConnection(v4, other);
+        matchesTuple &= (FlowKey(v4) == FlowKey(v6)) == sameConnection(v4, v6);
+    }
+    TEST_ASSERT(sizeof(FlowKey) == 40, "键没有填充字节");
+    TEST_ASSERT(canonical, "两个方向的四元组生成相同的键");
+    TEST_ASSERT(matchesTuple, "键的比较结果与四元组的连接匹配一致");
+
+    // 地址相同、端口不同的两个端点（本机连接）也能规范化
+    FourTuple loopback = makeTuple(3);
+    loopback.dstIPv4 = loopback.srcIPv4;
+    TEST_ASSERT(FlowKey(loopback) == FlowKey(loopback.reversed()), "地址相同的两个端点按端口排序");
+
+    // IPv4地址与对应的IPv4映射IPv6地址属于不同的连接
+    FourTuple mapped = makeTuple(5);
+    mapped.srcIPvN = 6;
+    mapped.dstIPvN = 6;
+    unsigned int srcIPv4 = makeTuple(5).srcIPv4;
+    unsigned int dstIPv4 = makeTuple(5).dstIPv4;
+    memset(mapped.srcIPv6, 0, 16);
+    memset(mapped.dstIPv6, 0, 16);
+    mapped.srcIPv6[10] = mapped.srcIPv6[11] = 0xff;
+    mapped.dstIPv6[10] = mapped.dstIPv6[11] = 0xff;
+    memcpy(mapped.srcIPv6 + 12, &srcIPv4, 4);
+    memcpy(mapped.dstIPv6 + 12, &dstIPv4, 4);
+    TEST_ASSERT(FlowKey(mapped) != FlowKey(makeTuple(5)), "IP版本参与比较");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 对称流哈希测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_symmetry();
+    allPassed &= test_distinct();
+    allPassed &= test_shard_balance();
+    allPassed &= test_bidirectional_packets();
+    allPassed &= test_flow_key();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file test_time_source.cpp
+ * @brief 流表时钟测试
+ *
+ * 本测试文件验证流表的时间来源(TimeSource)以及基于数据包时间戳的离线回放超时。
+ *
+ * 主要测试功能：
+ * 1. 单调时钟测试 - 验证now()返回缓存值，只有refresh()才会推进，且时间不回退
+ * 2. 数据包时间戳测试 - 验证时间由时间戳推进，乱序和缺失的时间戳不会让时间回退
+ * 3. 离线回放测试 - 以远快于抓包速度的节奏回放10分钟的流量，验证流按抓包时间而不是墙上时钟超时
+ * 4. 低流量活跃流测试 - 少量数据包持续超过超时时间，流的活动时间跟随实际时间，不被超时删除
+ */
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/flows/time_source.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 根据客户端端口生成IPv4四元组
+FourTuple makeTuple(int clientPort) {
+    FourTuple tuple;
+    memset(&tuple, 0, sizeof(tuple));
+    tuple.srcIPvN = 4;
+    tuple.dstIPvN = 4;
+    tuple.srcIPv4 = 0x0A000001u;
+    tuple.dstIPv4 = 0xC0A80001u;
+    tuple.sourcePort = clientPort;
+    tuple.destPort = 143;
+    return tuple;
+}
+
+// 构造一个带时间戳的C2S数据包
+InputPacket makePacket(int clientPort, int64_t timestampMs) {
+    InputPacket packet;
+    packet.type = "C2S";
+    packet.payload = "a1 NOOP\r\n";
+    packet.fourTuple = makeTuple(clientPort);
+    packet.timestamp = timestampMs;
+    return packet;
+}
+
+// 单调时钟模式
+bool test_monotonic() {
+    std::cout << "\n[单调时钟测试]" << std::endl;
+    TimeSource clock(TimeSourceMode::Monotonic);
+    int64_t first = clock.now();
+    TEST_ASSERT(first > 0, "构造后应已读取一次时钟");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    TEST_ASSERT(clock.now() == first, "未刷新时now()应返回缓存值");
+
+    int64_t refreshed = clock.refresh();
+    TEST_ASSERT(refreshed > first && clock.now() == refreshed, "刷新后时间应前进");
+
+    TEST_ASSERT(clock.observe(1) == clock.now() && clock.now() >= refreshed, "单调时钟模式下应忽略数据包时间戳");
+    return true;
+}
+
+// 数据包时间戳模式
+bool test_packet_timestamps() {
+    std::cout << "\n[数据包时间戳测试]" << std::endl;
+    TimeSource clock(TimeSourceMode::Packet);
+    TEST_ASSERT(clock.now() == 0, "数据包时间戳模式初始时间为0");
+
+    TEST_ASSERT(clock.observe(5000) == 5000, "时间戳推进时钟");
+    TEST_ASSERT(clock.observe(4000) == 5000, "乱序的旧时间戳不应让时间回退");
+    TEST_ASSERT(clock.observe(0) == 5000, "缺失的时间戳不应改变时间");
+    TEST_ASSERT(clock.refresh() == 5000, "数据包时间戳模式下refresh()不读取系统时钟");
+
+    TimeSourceMode mode = TimeSourceMode::Monotonic;
+    TEST_ASSERT(TimeSource::parseMode("packet", mode) && mode == TimeSourceMode::Packet, "解析packet");
+    TEST_ASSERT(!TimeSource::parseMode("wallclock", mode), "无法识别的名称应返回false");
+    return true;
+}
+
+// 离线回放：时间完全由数据包时间戳驱动
+bool test_replay() {
+    std::cout << "\n[离线回放测试]" << std::endl;
+    const int64_t base = 1700000000000LL;   // 抓包开始时间（毫秒）
+    const int64_t timeout = 30000;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    bool idleExpired = false;
+    bool activeKept = false;
+    bool activeExpired = false;
+    bool lastActivityMatches = false;
+    size_t flowsAfterFirstSweep = 0;
+    auto wallStart = std::chrono::steady_clock::now();
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizes(256, 256);
+        flowTable.setFlowTimeout(timeout);
+        flowTable.setTimingWheel(100, 3600000);
+        flowTable.setTimeSource(TimeSourceMode::Packet);
+
+        // 流1只在开始时出现一次；流2每10秒出现一次，持续2分钟
+        flowTable.processPacket(makePacket(50001, base));
+        for (int64_t t = 0; t <= 120000; t += 10000) {
+            flowTable.processPacket(makePacket(50002, base + t));
+            if (t == 40000) {
+                // 抓包时间已过去40秒，流1空闲超过超时时间
+                flowTable.checkAndCleanupTimeoutFlows();
+                flowsAfterFirstSweep = flowTable.getTotalFlows();
+                idleExpired = flowsAfterFirstSweep == 1;
+                Flow* active = flowTable.getOrCreateFlow(makeTuple(50002));
+                activeKept = active != nullptr && flowTable.getTotalFlows() == 1;
+                lastActivityMatches = active != nullptr && active->getLastActivityTime() == base + 40000;
+            }
+        }
+
+        // 回放到10分钟处（其他流量的时间戳推进时钟）
+        flowTable.processPacket(makePacket(50003, base + 600000));
+        flowTable.checkAndCleanupTimeoutFlows();
+        activeExpired = flowTable.getOrCreateFlow(makeTuple(50003)) != nullptr && flowTable.getTotalFlows() == 1;
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    std::cout << "  回放10分钟流量实际耗时: " << wallMs << " ms" << std::endl;
+    TEST_ASSERT(idleExpired, "抓包时间40秒时空闲的流1应已超时删除");
+    TEST_ASSERT(activeKept, "持续活跃的流2应保留");
+    TEST_ASSERT(lastActivityMatches, "流的最后活动时间应等于数据包时间戳");
+    TEST_ASSERT(activeExpired, "抓包时间10分钟时流2应已超时删除，只剩新流3");
+    return true;
+}
+
+// 单调时钟模式下，数据包间隔远小于超时时间的活跃流不会被超时删除
+bool test_active_flow_on_quiet_thread() {
+    std::cout << "\n[低流量活跃流测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    FlowTableStats whileActive;
+    FlowTableStats afterIdle;
+    {
+        HashFlowTable flowTable;
+        flowTable.setBufferSizes(256, 256);
+        flowTable.setFlowTimeout(200);
+        flowTable.setTimingWheel(10, 60000);
+        flowTable.setSweepPolicy(1024, 100, 64);
+
+        // 每20毫秒一个数据包，共25个（少于一批），持续时间超过超时时间
+        for (int i = 0; i < 25; ++i) {
+            flowTable.processPacket(makePacket(50001, 0));
+            flowTable.maybeSweep();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        // 最后一个数据包刚过去20毫秒，此时执行清理也不应删除该流
+        flowTable.checkAndCleanupTimeoutFlows();
+        whileActive = flowTable.getStats();
+
+        // 停止发送后超过超时时间，流被删除
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        flowTable.checkAndCleanupTimeoutFlows();
+        afterIdle = flowTable.getStats();
+    }
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(whileActive.timeouts == 0 && whileActive.flowsCreated == 1, "持续收到数据包的流不应超时删除");
+    TEST_ASSERT(afterIdle.timeouts == 1, "停止活动超过超时时间后流被删除");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 流表时钟测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_monotonic();
+    allPassed &= test_packet_timestamps();
+    allPassed &= test_replay();
+    allPassed &= test_active_flow_on_quiet_thread();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
@@ -0,0 +1,269 @@
+/**
+ * @file test_timeout_sweep.cpp
+ * @brief 分步超时清理测试
+ *
+ * 本测试文件验证HashFlowTable::sweepTimeoutFlows()每步最多处理指定数量的到期流，
+ * 以及maybeSweep()按数据包数量或时间间隔在数据包路径上触发清理。
+ * 测试使用数据包时间戳作为流表时钟，结果与运行速度无关。
+ *
+ * 主要测试功能：
+ * 1. 预算测试 - 每步处理的到期流不超过预算，未处理的计入待处理数量，后续步骤继续处理
+ * 2. 活动流测试 - 定时器到期后又有活动的流重新挂入，不被删除
+ * 3. 数据包间隔测试 - 每N个数据包执行一步清理
+ * 4. 时间间隔测试 - 距上一步超过T毫秒后执行一步清理
+ * 5. 单步耗时测试 - 大量流同时到期时，有预算的单步耗时远小于一次清理全部
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include "../include/flows/flow_manager.h"
+#include "../include/tools/types.h"
+#include "test_helpers.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 在指定时间向流i发送一个客户端数据包
+void touch(HashFlowTable& flowTable, size_t i, int64_t timestamp) {
+    static const std::string payload = "a1 NOOP\r\n";
+    PacketView view;
+    view.data = payload.data();
+    view.length = payload.size();
+    view.direction = PacketDirection::C2S;
+    view.fourTuple = makeTuple(i);
+    view.timestamp = timestamp;
+    flowTable.processPacket(view);
+}
+
+// 创建一个使用数据包时间戳、超时时间为1秒的流表
+HashFlowTable* makeTable() {
+    HashFlowTable* flowTable = new HashFlowTable();
+    flowTable->setTimeSource(TimeSourceMode::Packet);
+    flowTable->setFlowTimeout(1000);
+    flowTable->setBufferSizes(64, 64);
+    return flowTable;
+}
+
+// 每步处理的到期流不超过预算
+bool test_budget() {
+    std::cout << "\n[预算测试]" << std::endl;
+    const size_t flowCount = 1000;
+    const size_t budget = 100;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    HashFlowTable* flowTable = makeTable();
+    for (size_t i = 0; i < flowCount; i++) {
+        touch(*flowTable, i, 10000);
+    }
+    // 另一个流在所有流超时后才到达，推进流表时钟
+    touch(*flowTable, flowCount, 20000);
+
+    size_t firstDeleted = flowTable->sweepTimeoutFlows(budget);
+    size_t pendingAfterFirst = flowTable->getPendingExpiry();
+    uint64_t statsPending = flowTable->getStats().pendingExpiry;
+    size_t flowsAfterFirst = flowTable->getTotalFlows();
+
+    size_t steps = 1;
+    size_t totalDeleted = firstDeleted;
+    while (flowTable->getPendingExpiry() > 0 && steps < 100) {
+        totalDeleted += flowTable->sweepTimeoutFlows(budget);
+        ++steps;
+    }
+    size_t remaining = flowTable->getTotalFlows();
+    FlowTableStats stats = flowTable->getStats();
+    delete flowTable;
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(firstDeleted == budget, "第一步只删除预算数量的流");
+    TEST_ASSERT(pendingAfterFirst == flowCount - budget, "其余到期的流等待处理");
+    TEST_ASSERT(statsPending == pendingAfterFirst, "统计中的待处理数量一致");
+    TEST_ASSERT(flowsAfterFirst == flowCount + 1 - budget, "流表中还剩未处理的流");
+    TEST_ASSERT(steps == flowCount / budget, "按预算分步处理完所有到期的流");
+    TEST_ASSERT(totalDeleted == flowCount && remaining == 1, "只剩未超时的流");
+    TEST_ASSERT(stats.timeouts == flowCount && stats.pendingExpiry == 0, "超时数量和待处理数量");
+    return true;
+}
+
+// 定时器到期后又有活动的流不被删除
+bool test_active_flow_survives() {
+    std::cout << "\n[活动流测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    HashFlowTable* flowTable = makeTable();
+    for (size_t i = 0; i < 10; i++) {
+        touch(*flowTable, i, 10000);
+    }
+    // 流5在定时器到期之后、清理之前又有活动
+    touch(*flowTable, 5, 20000);
+
+    size_t deleted = 0;
+    size_t steps = 0;
+    do {
+        deleted += flowTable->sweepTimeoutFlows(3);
+        ++steps;
+    } while (flowTable->getPendingExpiry() > 0 && steps < 100);
+    size_t remaining = flowTable->getTotalFlows();
+    bool flow5Alive = flowTable->getAllFlows().size() == 1 &&
+                      flowTable->getAllFlows()[0]->getC2STuple().sourcePort == makeTuple(5).sourcePort;
+    delete flowTable;
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(deleted == 9 && remaining == 1, "删除9个超时的流");
+    TEST_ASSERT(flow5Alive, "有活动的流重新挂入定时器");
+    return true;
+}
+
+// 每N个数据包执行一步清理
+bool test_packet_interval() {
+    std::cout << "\n[数据包间隔测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    HashFlowTable* flowTable = makeTable();
+    for (size_t i = 0; i < 20; i++) {
+        touch(*flowTable, i, 10000);
+    }
+    flowTable->setSweepPolicy(10, 0, 5);
+
+    // 所有流超时后，前9个数据包不触发清理，第10个数据包触发一步
+    size_t deletedBefore = 0;
+    for (size_t n = 0; n < 9; n++) {
+        touch(*flowTable, 100, 20000);
+        deletedBefore += flowTable->maybeSweep();
+    }
+    touch(*flowTable, 100, 20000);
+    size_t deletedAtTenth = flowTable->maybeSweep();
+    size_t pending = flowTable->getPendingExpiry();
+
+    // 再处理30个数据包，剩余的15个到期流分3步处理完
+    size_t deletedLater = 0;
+    for (size_t n = 0; n < 30; n++) {
+        touch(*flowTable, 100, 20000);
+        deletedLater += flowTable->maybeSweep();
+    }
+    size_t remaining = flowTable->getTotalFlows();
+    delete flowTable;
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(deletedBefore == 0, "未到间隔时不清理");
+    TEST_ASSERT(deletedAtTenth == 5 && pending == 15, "到达间隔时按预算清理一步");
+    TEST_ASSERT(deletedLater == 15 && remaining == 1, "后续步骤清理完所有超时的流");
+    return true;
+}
+
+// 距上一步超过T毫秒后执行一步清理
+bool test_time_interval() {
+    std::cout << "\n[时间间隔测试]" << std::endl;
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    HashFlowTable* flowTable = makeTable();
+    touch(*flowTable, 0, 10000);
+    flowTable->setSweepPolicy(0, 5000, 0);
+
+    // 距设置时（10000毫秒）不足5000毫秒，即使流已超时也不清理
+    touch(*flowTable, 1, 14000);
+    size_t deletedEarly = flowTable->maybeSweep();
+    // 到达15000毫秒，执行一步清理
+    touch(*flowTable, 1, 15000);
+    size_t deletedDue = flowTable->maybeSweep();
+    // 刚清理过，流1超时后也要等下一个间隔
+    touch(*flowTable, 2, 17000);
+    size_t deletedAgain = flowTable->maybeSweep();
+    touch(*flowTable, 2, 20000);
+    size_t deletedNext = flowTable->maybeSweep();
+    size_t remaining = flowTable->getTotalFlows();
+    delete flowTable;
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    TEST_ASSERT(deletedEarly == 0, "未到时间间隔时不清理");
+    TEST_ASSERT(deletedDue == 1, "到达时间间隔时清理超时的流");
+    TEST_ASSERT(deletedAgain == 0, "清理后重新计时");
+    TEST_ASSERT(deletedNext == 1 && remaining == 1, "下一个间隔清理新超时的流");
+    return true;
+}
+
+// 大量流同时到期时单步耗时有上限
+bool test_step_latency() {
+    std::cout << "\n[单步耗时测试]" << std::endl;
+    const size_t flowCount = 200000;
+    const size_t budget = 256;
+
+    NullBuffer nullBuffer;
+    std::streambuf* oldCoutStreamBuf = std::cout.rdbuf(&nullBuffer);
+
+    double unboundedMs = 0;
+    double maxStepMs = 0;
+    size_t steps = 0;
+    for (int round = 0; round < 2; round++) {
+        HashFlowTable* flowTable = makeTable();
+        for (size_t i = 0; i < flowCount; i++) {
+            touch(*flowTable, i, 10000);
+        }
+        touch(*flowTable, flowCount, 20000);
+
+        if (round == 0) {
+            auto start = std::chrono::high_resolution_clock::now();
+            flowTable->checkAndCleanupTimeoutFlows();
+            unboundedMs = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+        } else {
+            do {
+                auto start = std::chrono::high_resolution_clock::now();
+                flowTable->sweepTimeoutFlows(budget);
+                double stepMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+                if (stepMs > maxStepMs) {
+                    maxStepMs = stepMs;
+                }
+                ++steps;
+            } while (flowTable->getPendingExpiry() > 0);
+        }
+        delete flowTable;
+    }
+
+    std::cout.rdbuf(oldCoutStreamBuf);
+
+    std::cout << "  " << flowCount << " 个流同时到期: 一次清理 " << unboundedMs << " ms, 分 " << steps
+              << " 步清理时单步最长 " << maxStepMs << " ms" << std::endl;
+    TEST_ASSERT(steps == (flowCount + budget - 1) / budget, "按预算分步");
+    TEST_ASSERT(maxStepMs < unboundedMs, "单步耗时小于一次清理全部");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 分步超时清理测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_budget();
+    allPassed &= test_active_flow_survives();
+    allPassed &= test_packet_interval();
+    allPassed &= test_time_interval();
+    allPassed &= test_step_latency();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
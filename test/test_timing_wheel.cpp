@@ -0,0 +1,159 @@
+/**
+ * @file test_timing_wheel.cpp
+ * @brief 分层时间轮测试
+ *
+ * 本测试文件验证流超时所用的分层时间轮(TimingWheel)的正确性。
+ *
+ * 主要测试功能：
+ * 1. 到期时间测试 - 随机挂入跨越多层的定时器，逐刻度推进，验证每个定时器恰好在到期刻度被取出
+ * 2. 取消与移动测试 - 验证取消后的定时器不会到期、移动后的定时器按新时间到期
+ * 3. 超出覆盖范围测试 - 验证超出范围的定时器在范围末端提前到期
+ * 4. 大步推进测试 - 一次推进很长时间，验证所有定时器都被取出
+ */
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include "../include/flows/timing_wheel.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 随机定时器逐刻度推进，验证到期时间精确
+bool test_expire_exactly() {
+    std::cout << "\n[到期时间测试]" << std::endl;
+    // 刻度10毫秒，覆盖约11小时（3层）
+    TimingWheel wheel(10, 40000000);
+    wheel.reset(0);
+
+    const size_t count = 5000;
+    std::vector<TimerNode> nodes(count);
+    std::vector<int64_t> expireMs(count);
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < count; i++) {
+        // 到期时间分布在0到300秒之间，覆盖第0、1、2层
+        expireMs[i] = 10 * static_cast<int64_t>(rng() % 30000);
+        nodes[i].owner = &expireMs[i];
+        wheel.schedule(&nodes[i], expireMs[i]);
+    }
+
+    size_t fired = 0;
+    bool allExact = true;
+    for (int64_t now = 0; now <= 300000; now += 10) {
+        wheel.advance(now);
+        while (TimerNode* node = wheel.popExpired()) {
+            int64_t expected = *static_cast<int64_t*>(node->owner);
+            if (expected != now) {
+                allExact = false;
+            }
+            fired++;
+        }
+    }
+    TEST_ASSERT(fired == count, "所有定时器都应到期");
+    TEST_ASSERT(allExact, "每个定时器都应恰好在到期刻度被取出");
+    TEST_ASSERT(wheel.scheduledCount() == 0 && wheel.pendingExpired() == 0, "时间轮应为空");
+    return true;
+}
+
+// 取消和移动定时器
+bool test_cancel_and_move() {
+    std::cout << "\n[取消与移动测试]" << std::endl;
+    TimingWheel wheel(1, 100000);
+    wheel.reset(1000);
+
+    TimerNode a, b, c;
+    wheel.schedule(&a, 1100);
+    wheel.schedule(&b, 1200);
+    wheel.schedule(&c, 5000);
+    TEST_ASSERT(wheel.scheduledCount() == 3, "挂入3个定时器");
+
+    wheel.cancel(&a);
+    TEST_ASSERT(!a.isLinked() && wheel.scheduledCount() == 2, "取消后定时器应被摘下");
+
+    // 把c从第1层移动到很近的时间
+    wheel.schedule(&c, 1050);
+    wheel.advance(1050);
+    TEST_ASSERT(wheel.popExpired() == &c, "移动后的定时器应按新时间到期");
+    TEST_ASSERT(wheel.popExpired() == nullptr, "此时不应有其他定时器到期");
+
+    wheel.advance(1199);
+    TEST_ASSERT(wheel.popExpired() == nullptr, "未到期的定时器不应被取出");
+    wheel.advance(1200);
+    TEST_ASSERT(wheel.popExpired() == &b, "b应在1200毫秒到期");
+
+    // 已经过期的时间直接进入到期链表，也可以在到期链表中被取消
+    wheel.schedule(&a, 10);
+    TEST_ASSERT(wheel.pendingExpired() == 1, "过去的时间应立即到期");
+    wheel.cancel(&a);
+    TEST_ASSERT(wheel.pendingExpired() == 0 && wheel.popExpired() == nullptr, "到期链表中的定时器可以被取消");
+    return true;
+}
+
+// 超出覆盖范围的定时器
+bool test_beyond_horizon() {
+    std::cout << "\n[超出覆盖范围测试]" << std::endl;
+    // 刻度1毫秒，覆盖范围取整后为4095毫秒（2层）
+    TimingWheel wheel(1, 1000);
+    wheel.reset(0);
+    TEST_ASSERT(wheel.horizon() == 4095, "覆盖范围应向上取整到整层");
+
+    TimerNode node;
+    wheel.schedule(&node, 100000);
+    wheel.advance(4094);
+    TEST_ASSERT(wheel.popExpired() == nullptr, "覆盖范围末端之前不应到期");
+    wheel.advance(4095);
+    TEST_ASSERT(wheel.popExpired() == &node, "超出范围的定时器应在范围末端提前到期");
+    return true;
+}
+
+// 一次推进很长时间
+bool test_large_advance() {
+    std::cout << "\n[大步推进测试]" << std::endl;
+    TimingWheel wheel(1000, 3600000);
+    wheel.reset(0);
+
+    std::vector<TimerNode> nodes(1000);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        wheel.schedule(&nodes[i], static_cast<int64_t>(i) * 3000);
+    }
+    wheel.advance(10000000);
+    size_t fired = 0;
+    while (wheel.popExpired() != nullptr) {
+        fired++;
+    }
+    TEST_ASSERT(fired == nodes.size(), "一次推进后所有定时器都应到期");
+
+    // 时间轮为空时推进直接跳到目标时间
+    TimerNode late;
+    wheel.schedule(&late, 10000000 + 500);
+    wheel.advance(10000000 + 1000);
+    TEST_ASSERT(wheel.popExpired() == &late, "跳跃后新挂入的定时器应正常到期");
+    return true;
+}
+
+int main() {
+    std::cout << "======= 分层时间轮测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_expire_exactly();
+    allPassed &= test_cancel_and_move();
+    allPassed &= test_beyond_horizon();
+    allPassed &= test_large_advance();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}
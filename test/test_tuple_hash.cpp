@@ -0,0 +1,256 @@
+/**
+ * @file test_tuple_hash.cpp
+ * @brief 四元组哈希质量与性能测试
+ *
+ * 本测试文件在接近实际的IPv4和IPv6地址分布上验证hashTuple()的两种实现（硬件CRC32C和便携实现），
+ * 并与原来逐字节组合、截断为int的哈希比较速度和冲突数量。
+ *
+ * 主要测试功能：
+ * 1. 一致性测试 - 两种实现都对两个方向对称，hashFourTuple()使用运行时选择的实现
+ * 2. 冲突测试 - 同一客户端子网的大量连接得到互不相同的64位哈希值
+ * 3. 分布测试 - 低位（流索引槽位）的卡方统计量接近理想值，高位（分片）各分片连接数均衡
+ * 4. 性能测试 - 每次哈希的耗时（只输出，不作断言）
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include "../include/flows/flow_manager.h"
+#include "../include/flows/tuple_hash.h"
+#include "../include/tools/types.h"
+
+using namespace flow_table;
+
+// 简单的断言宏，用于测试
+#define TEST_ASSERT(condition, message) \
+    do { \
+        std::cout << "  检查: " << message << std::endl; \
+        if (!(condition)) { \
+            std::cerr << "  断言失败: " << message << " 在 " << __FILE__ << " 行 " << __LINE__ << std::endl; \
+            return false; \
+        } \
+        std::cout << "  结果: 通过" << std::endl; \
+    } while (0)
+
+// 确定性的伪随机数生成器（SplitMix64），每次运行得到相同的地址
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+private:
+    uint64_t state;
+};
+
+// IPv4：10.1.0.0/16内的2000台客户端，每台使用临时端口连接3台服务器的143或993端口
+std::vector<FourTuple> makeIPv4Tuples(size_t count) {
+    Random random(1);
+    std::vector<FourTuple> tuples;
+    tuples.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        FourTuple tuple;
+        memset(&tuple, 0, sizeof(tuple));
+        tuple.srcIPvN = 4;
+        tuple.dstIPvN = 4;
+        tuple.srcIPv4 = 0x0A010000u + static_cast<unsigned int>(i % 2000);
+        tuple.sourcePort = 49152 + static_cast<int>((i / 2000) % 16384);
+        tuple.dstIPv4 = 0xC0A80A01u + static_cast<unsigned int>(random.next() % 3);
+        tuple.destPort = random.next() % 2 == 0 ? 143 : 993;
+        tuples.push_back(tuple);
+    }
+    return tuples;
+}
+
+// IPv6：2001:db8:0:1::/64内的客户端，一半使用随机接口标识（SLAAC隐私地址），一半按序号分配（DHCPv6），
+// 使用临时端口连接同一台服务器的993端口
+std::vector<FourTuple> makeIPv6Tuples(size_t count) {
+    static const unsigned char prefix[8] = {0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x01};
+    Random random(2);
+    std::vector<FourTuple> tuples;
+    tuples.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        FourTuple tuple;
+        memset(&tuple, 0, sizeof(tuple));
+        tuple.srcIPvN = 6;
+        tuple.dstIPvN = 6;
+        memcpy(tuple.srcIPv6, prefix, 8);
+        uint64_t host = i % 2 == 0 ? random.next() : static_cast<uint64_t>(i / 2 % 4000 + 1);
+        for (int b = 0; b < 8; b++) {
+            tuple.srcIPv6[15 - b] = static_cast<unsigned char>(host >> (8 * b));
+        }
+        tuple.sourcePort = 49152 + static_cast<int>((i / 8000) % 16384);
+        memcpy(tuple.dstIPv6, prefix, 8);
+        tuple.dstIPv6[15] = 0x10;
+        tuple.destPort = 993;
+        tuples.push_back(tuple);
+    }
+    return tuples;
+}
+
+// 原来的哈希：逐字节组合，截断为int（只用于比较）
+uint64_t legacyHash(const FourTuple& fourTuple) {
+    std::size_t hash = 0;
+    if (fourTuple.srcIPvN == 4) {
+        hash = std::hash<uint32_t>{}(fourTuple.srcIPv4);
+        hash ^= std::hash<uint32_t>{}(fourTuple.dstIPv4) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    } else if (fourTuple.srcIPvN == 6) {
+        for (int i = 0; i < 16; i++) {
+            hash ^= std::hash<unsigned char>{}(fourTuple.srcIPv6[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            hash ^= std::hash<unsigned char>{}(fourTuple.dstIPv6[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+    }
+    hash ^= std::hash<int>{}(fourTuple.sourcePort) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>{}(fourTuple.destPort) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return static_cast<uint64_t>(static_cast<unsigned int>(static_cast<int>(hash)));
+}
+
+const char* kindName(TupleHashKind kind) {
+    return kind == TupleHashKind::Crc32c ? "CRC32C" : "便携实现";
+}
+
+// 两种实现都对称，hashFourTuple()使用运行时选择的实现
+bool test_consistency() {
+    std::cout << "\n[一致性测试]" << std::endl;
+    std::cout << "  当前使用: " << kindName(activeTupleHash()) << std::endl;
+    std::vector<FourTuple> tuples = makeIPv4Tuples(10000);
+    std::vector<FourTuple> v6 = makeIPv6Tuples(10000);
+    tuples.insert(tuples.end(), v6.begin(), v6.end());
+
+    bool symmetric = true;
+    bool matchesActive = true;
+    for (const FourTuple& tuple : tuples) {
+        for (TupleHashKind kind : {TupleHashKind::Portable, TupleHashKind::Crc32c}) {
+            symmetric &= hashTuple(tuple, kind) == hashTuple(tuple.reversed(), kind);
+        }
+        matchesActive &= HashFlowTable::hashFourTuple(tuple) == hashTuple(tuple, activeTupleHash()) &&
+                         hashTuple(tuple) == hashTuple(tuple, activeTupleHash());
+    }
+    TEST_ASSERT(symmetric, "两种实现对两个方向的哈希值相同");
+    TEST_ASSERT(matchesActive, "流表使用运行时选择的实现");
+    return true;
+}
+
+// 冲突数量和分布
+bool checkQuality(const char* name, const std::vector<FourTuple>& tuples, TupleHashKind kind) {
+    const size_t bucketBits = 16;
+    const size_t buckets = static_cast<size_t>(1) << bucketBits;
+    const unsigned int shards = 8;
+
+    std::set<uint64_t> distinct;
+    std::vector<size_t> bucketCounts(buckets, 0);
+    std::vector<size_t> shardCounts(shards, 0);
+    for (const FourTuple& tuple : tuples) {
+        uint64_t hash = hashTuple(tuple, kind);
+        distinct.insert(hash);
+        bucketCounts[hash & (buckets - 1)]++;
+        shardCounts[((hash >> 32) * shards) >> 32]++;
+    }
+
+    // 低位的卡方统计量除以自由度，理想的均匀分布约为1
+    double expected = static_cast<double>(tuples.size()) / buckets;
+    double chiSquare = 0;
+    for (size_t n : bucketCounts) {
+        chiSquare += (n - expected) * (n - expected) / expected;
+    }
+    double chiRatio = chiSquare / (buckets - 1);
+    size_t minShard = tuples.size();
+    size_t maxShard = 0;
+    for (size_t n : shardCounts) {
+        minShard = n < minShard ? n : minShard;
+        maxShard = n > maxShard ? n : maxShard;
+    }
+
+    std::cout << "  " << name << " " << kindName(kind) << ": " << tuples.size() << " 个连接, 冲突 "
+              << tuples.size() - distinct.size() << ", 槽位卡方/自由度 " << std::fixed << std::setprecision(3)
+              << chiRatio << ", 分片 " << minShard << " ~ " << maxShard << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+
+    size_t perShard = tuples.size() / shards;
+    TEST_ASSERT(distinct.size() == tuples.size(), "64位哈希值没有冲突");
+    TEST_ASSERT(chiRatio > 0.95 && chiRatio < 1.05, "低位在索引槽位上均匀分布");
+    TEST_ASSERT(minShard > perShard * 97 / 100 && maxShard < perShard * 103 / 100, "高位在分片之间均匀分布");
+    return true;
+}
+
+bool test_quality() {
+    std::cout << "\n[冲突与分布测试]" << std::endl;
+    const size_t count = 400000;
+    std::vector<FourTuple> v4 = makeIPv4Tuples(count);
+    std::vector<FourTuple> v6 = makeIPv6Tuples(count);
+
+    // 原来的哈希作为对照，只输出冲突数量
+    std::set<uint64_t> legacyV4, legacyV6;
+    for (size_t i = 0; i < count; i++) {
+        legacyV4.insert(legacyHash(v4[i]));
+        legacyV6.insert(legacyHash(v6[i]));
+    }
+    std::cout << "  原逐字节哈希: IPv4冲突 " << count - legacyV4.size() << ", IPv6冲突 "
+              << count - legacyV6.size() << std::endl;
+
+    for (TupleHashKind kind : {TupleHashKind::Portable, TupleHashKind::Crc32c}) {
+        if (!checkQuality("IPv4", v4, kind) || !checkQuality("IPv6", v6, kind)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 每次哈希的耗时（纳秒）
+template <typename Hash>
+double measure(const std::vector<FourTuple>& tuples, Hash hash, uint64_t& checksum) {
+    const int rounds = 20;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const FourTuple& tuple : tuples) {
+            checksum += hash(tuple);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+    return ns / (static_cast<double>(tuples.size()) * rounds);
+}
+
+bool test_performance() {
+    std::cout << "\n[性能测试]" << std::endl;
+    const size_t count = 100000;
+    std::vector<FourTuple> v4 = makeIPv4Tuples(count);
+    std::vector<FourTuple> v6 = makeIPv6Tuples(count);
+
+    uint64_t checksum = 0;
+    std::cout << std::fixed << std::setprecision(2);
+    double legacyV4 = measure(v4, legacyHash, checksum);
+    double legacyV6 = measure(v6, legacyHash, checksum);
+    std::cout << "  原逐字节哈希: IPv4 " << legacyV4 << " ns, IPv6 " << legacyV6 << " ns" << std::endl;
+    for (TupleHashKind kind : {TupleHashKind::Portable, TupleHashKind::Crc32c}) {
+        auto hash = [kind](const FourTuple& tuple) { return hashTuple(tuple, kind); };
+        double nsV4 = measure(v4, hash, checksum);
+        double nsV6 = measure(v6, hash, checksum);
+        std::cout << "  " << kindName(kind) << ": IPv4 " << nsV4 << " ns, IPv6 " << nsV6 << " ns" << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << "  校验和: " << checksum << std::endl;
+    return true;
+}
+
+int main() {
+    std::cout << "======= 四元组哈希测试 =======" << std::endl;
+
+    bool allPassed = true;
+    allPassed &= test_consistency();
+    allPassed &= test_quality();
+    allPassed &= test_performance();
+
+    if (!allPassed) {
+        std::cerr << "\n部分测试失败" << std::endl;
+        return 1;
+    }
+    std::cout << "\n======= 所有测试通过 =======" << std::endl;
+    return 0;
+}